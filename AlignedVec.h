@@ -0,0 +1,51 @@
+#pragma once
+#include <bit>            // std::has_single_bit
+#include <cstddef>
+#include <limits>         // std::numeric_limits
+#include <new>            // std::bad_alloc, std::align_val_t
+#include "Vec.h"
+
+// allocator whose every buffer starts on an 'Alignment' byte boundary: 64 for a cache
+// line or an AVX-512 register, 32 for AVX. The alignment is part of the type, so Vec
+// knows it at compile time (Vec::alignment) and passes it on through data().
+template<typename T, size_t Alignment>
+class AlignedAllocator{
+	static_assert(std::has_single_bit(Alignment),
+		"AlignedAllocator: Alignment must be a power of two");
+	static_assert(Alignment >= alignof(T), "AlignedAllocator: Alignment is less than alignof(T)");
+
+public:
+	using value_type = T;
+	static constexpr size_t alignment = Alignment;
+
+	// the alignment is a non-type template parameter, so we have to spell out how to rebind.
+	template<typename U>
+	struct rebind{
+		using other = AlignedAllocator<U, Alignment>;
+	};
+
+	AlignedAllocator() noexcept = default;
+	template<typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept{}
+
+	auto allocate(size_t count) -> T*{
+		if(count > std::numeric_limits<size_t>::max() / sizeof(T)){
+			throw std::bad_alloc();
+		}
+		return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+	}
+	auto deallocate(T* p, size_t count) noexcept -> void{
+		::operator delete(p, count * sizeof(T), std::align_val_t{Alignment});
+	}
+
+	template<typename U>
+	friend bool operator==(const AlignedAllocator&, const AlignedAllocator<U, Alignment>&) noexcept{
+		return true;
+	}
+};
+
+// a Vec whose data() is 'Alignment'-aligned, and says so:
+//	AlignedVec<float, 64> samples(n);
+//	kernel(samples.data(), samples.size()); // _mm512_load_ps is safe on samples.data()
+template<typename T, size_t Alignment = 64>
+using AlignedVec = Vec<T, AlignedAllocator<T, Alignment>>;
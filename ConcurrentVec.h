@@ -0,0 +1,343 @@
+#pragma once
+#include <algorithm>      // std::max, std::min
+#include <array>
+#include <atomic>
+#include <bit>            // std::bit_floor, std::bit_width, std::countr_zero
+#include <cassert>        // assert, catching bugs in debug builds
+#include <cstddef>        // std::byte
+#include <iterator>       // std::random_access_iterator_tag
+#include <limits>         // std::numeric_limits
+#include <memory>         // std::construct_at, std::destroy_at
+#include <new>            // std::align_val_t
+#include <stdexcept>      // std::out_of_range, std::length_error
+#include <type_traits>
+#include <utility>        // std::forward
+#include "Vec.h"
+#include "VecView.h"
+
+#pragma warning(push)
+#pragma warning(disable : 26446) // bounds.4 - subscript operator use
+#pragma warning(disable : 26481) // bounds.1 - pointer arithmetic, we manage raw storage ourselves
+#pragma warning(disable : 26490) // type.1 - reinterpret_cast, raw segment bytes become T's
+
+// ConcurrentVec<T> is an append-only Vec for many producer threads at once, no mutex.
+// Elements live in segments that double in size (first_segment, 2x that, 4x, ...),
+// allocated when the first element lands in them and never moved after that. So:
+//	- push_back is lock-free: it makes sure the next slot's segment exists, claims the
+//	  slot with a compare-exchange (tried again only when another push took it first),
+//	  then builds the element in place. No thread ever waits for another one, and a
+//	  contended push loses a round only because some other push made progress.
+//	- references returned by push_back stay valid for the lifetime of the ConcurrentVec.
+//	- snapshot() gives a read-only view of every element finished so far. Its size is
+//	  frozen, so it can be read while the producers carry on.
+// A claimed slot must be filled: the element constructor has to be noexcept, or a failed
+// push would leave a hole that size() never gets past. Move in what might throw.
+// Everything else that can fail, max_size() and allocating the segment, is done before
+// the slot is claimed: a push that throws std::bad_alloc leaves no trace.
+template<typename T>
+class ConcurrentVec{
+	static_assert(std::is_object_v<T> && std::destructible<T>,
+		"ConcurrentVec<T> requires T to be a destructible object type");
+
+public:
+	using value_type = T;
+	using size_type = size_t;
+	using reference = T&;
+	using const_reference = const T&;
+
+	// elements in the first segment: about a KiB worth of them.
+	static constexpr size_type first_segment =
+		std::bit_floor(std::max<size_t>(1, 1024 / sizeof(T)));
+
+	class Snapshot;
+
+	ConcurrentVec() noexcept = default;
+
+	// not while anyone is still pushing, of course.
+	~ConcurrentVec() noexcept{
+		const size_type claimed = std::min(_claimed.load(std::memory_order_acquire), max_size());
+		for(size_type k = 0; k < segment_count; ++k){
+			std::byte* segment = _segments[k].load(std::memory_order_acquire);
+			if(!segment){
+				continue;
+			}
+			const size_type first = segment_start(k);
+			const size_type count =
+				claimed > first ? std::min(claimed - first, segment_size(k)) : 0;
+			for(size_type i = 0; i < count; ++i){
+				if(flags_of(segment, k)[i].load(std::memory_order_acquire)){
+					std::destroy_at(elements_of(segment) + i);
+				}
+			}
+			free_segment(segment, k);
+		}
+	}
+
+	// other threads hold references into it, so it stays where it is.
+	ConcurrentVec(const ConcurrentVec&) = delete;
+	ConcurrentVec& operator=(const ConcurrentVec&) = delete;
+
+	// safe to call from any number of threads at once. Returns the new element, which
+	// never moves: the reference stays good for as long as *this lives.
+	template<typename... Args> requires std::is_nothrow_constructible_v<T, Args...>
+	auto emplace_back(Args&&... args) -> reference{
+		size_type index = _claimed.load(std::memory_order_relaxed);
+		for(;;){
+			if(index >= max_size()){
+				throw std::length_error("ConcurrentVec: cannot grow beyond max_size()");
+			}
+			// (a plain fetch_add would be wait-free, but then an allocation failing here
+			// would leave a claimed slot that is never filled.)
+			const auto [k, offset] = locate(index);
+			std::byte* segment = segment_for(k);
+			if(_claimed.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)){
+				T* element =
+					std::construct_at(elements_of(segment) + offset, std::forward<Args>(args)...);
+				flags_of(segment, k)[offset].store(true, std::memory_order_release);
+				return *element;
+			}
+			// 'index' was reloaded: somebody else took that slot, try the next one
+		}
+	}
+	auto push_back(const T& value) -> reference requires std::is_nothrow_copy_constructible_v<T>{
+		return emplace_back(value);
+	}
+	auto push_back(T&& value) -> reference requires std::is_nothrow_move_constructible_v<T>{
+		return emplace_back(std::move(value));
+	}
+
+	// the number of elements ready to be read: every slot before this one is filled.
+	// Pushes still under way on other threads are not counted yet.
+	// The _ready hint is published with release and read with acquire: a reader that
+	// takes another reader's word for the first 'ready' slots then also sees what the
+	// producers wrote into them, as if it had checked their flags itself.
+	auto size() const noexcept -> size_type{
+		const size_type claimed = std::min(_claimed.load(std::memory_order_acquire), max_size());
+		size_type ready = _ready.load(std::memory_order_acquire);
+		while(ready < claimed && is_ready(ready)){
+			++ready;
+		}
+		// remember how far we got, so the next call doesn't scan it all again
+		size_type known = _ready.load(std::memory_order_acquire);
+		while(known < ready && !_ready.compare_exchange_weak(known, ready,
+			std::memory_order_acq_rel, std::memory_order_acquire)){
+			// 'known' was reloaded, try again unless someone got further
+		}
+		return ready;
+	}
+	auto empty() const noexcept -> bool{ return size() == 0; }
+
+	auto max_size() const noexcept -> size_type{
+		return std::numeric_limits<size_type>::max() / sizeof(T);
+	}
+
+	// any element counted by size(), from any thread.
+	auto operator[](size_type index) noexcept -> reference{
+		assert(is_ready(index) && "ConcurrentVec: reading an element that isn't there yet");
+		return *element_at(index);
+	}
+	auto operator[](size_type index) const noexcept -> const_reference{
+		assert(is_ready(index) && "ConcurrentVec: reading an element that isn't there yet");
+		return *element_at(index);
+	}
+
+	// a read-only view of the first size() elements, as of now.
+	auto snapshot() const noexcept -> Snapshot{
+		return Snapshot(this, size());
+	}
+
+private:
+	static constexpr size_type first_segment_shift = std::countr_zero(first_segment);
+	// enough segments to address every index a size_t can hold
+	static constexpr size_type segment_count =
+		std::numeric_limits<size_type>::digits - first_segment_shift;
+
+	struct Location{
+		size_type segment;
+		size_type offset;
+	};
+
+	// segment k holds first_segment << k elements, starting at index first_segment * (2^k - 1)
+	static auto segment_size(size_type k) noexcept -> size_type{ return first_segment << k; }
+	static auto segment_start(size_type k) noexcept -> size_type{
+		return first_segment * ((size_type{1} << k) - 1);
+	}
+	static auto locate(size_type index) noexcept -> Location{
+		const size_type k = std::bit_width((index >> first_segment_shift) + 1) - 1;
+		return {k, index - segment_start(k)};
+	}
+
+	// a segment is its elements, followed by one 'ready' flag per element.
+	static constexpr size_t segment_alignment = std::max(alignof(T), alignof(std::atomic<bool>));
+
+	static auto segment_bytes(size_type k) noexcept -> size_t{
+		return segment_size(k) * (sizeof(T) + sizeof(std::atomic<bool>));
+	}
+	static auto elements_of(std::byte* segment) noexcept -> T*{
+		return reinterpret_cast<T*>(segment);
+	}
+	static auto flags_of(std::byte* segment, size_type k) noexcept -> std::atomic<bool>*{
+		return reinterpret_cast<std::atomic<bool>*>(segment + segment_size(k) * sizeof(T));
+	}
+
+	// segment k, allocating it if we are the first to need it. Everybody racing to do
+	// that makes one attempt to install theirs: the winner's is used, the others free
+	// their own. No retry loop of its own.
+	auto segment_for(size_type k) -> std::byte*{
+		std::byte* segment = _segments[k].load(std::memory_order_acquire);
+		if(segment){
+			return segment;
+		}
+		if(segment_size(k) > max_size() / 2){
+			throw std::length_error("ConcurrentVec: segment too large");
+		}
+		std::byte* fresh = static_cast<std::byte*>(
+			::operator new(segment_bytes(k), std::align_val_t{segment_alignment}));
+		std::atomic<bool>* flags = flags_of(fresh, k);
+		for(size_type i = 0; i < segment_size(k); ++i){
+			std::construct_at(flags + i, false);
+		}
+		if(_segments[k].compare_exchange_strong(segment, fresh, std::memory_order_acq_rel)){
+			return fresh;
+		}
+		free_segment(fresh, k);
+		return segment; // the winner's, loaded by the failed exchange
+	}
+
+	static auto free_segment(std::byte* segment, size_type k) noexcept -> void{
+		::operator delete(segment, segment_bytes(k), std::align_val_t{segment_alignment});
+	}
+
+	auto is_ready(size_type index) const noexcept -> bool{
+		const auto [k, offset] = locate(index);
+		std::byte* segment = _segments[k].load(std::memory_order_acquire);
+		return segment && flags_of(segment, k)[offset].load(std::memory_order_acquire);
+	}
+
+	auto element_at(size_type index) const noexcept -> T*{
+		const auto [k, offset] = locate(index);
+		return elements_of(_segments[k].load(std::memory_order_acquire)) + offset;
+	}
+
+	std::array<std::atomic<std::byte*>, segment_count> _segments{};
+	std::atomic<size_type> _claimed{0};
+	mutable std::atomic<size_type> _ready{0}; // only a hint, for size(): all below it are ready
+};
+
+// the first size() elements of a ConcurrentVec at the time of the snapshot. The producers
+// may go on appending: they never touch these elements, so reading them needs no locks.
+// The storage isn't one array, but it is a handful of contiguous ones, each a VecView.
+template<typename T>
+class ConcurrentVec<T>::Snapshot{
+public:
+	class const_iterator{
+	public:
+		using iterator_concept = std::random_access_iterator_tag;
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const T*;
+		using reference = const T&;
+
+		const_iterator() noexcept = default;
+		const_iterator(const ConcurrentVec* owner, size_type index) noexcept
+			: _owner(owner)
+			, _index(index){}
+
+		auto operator*() const noexcept -> reference{ return *_owner->element_at(_index); }
+		auto operator->() const noexcept -> pointer{ return _owner->element_at(_index); }
+		auto operator[](difference_type n) const noexcept -> reference{ return *(*this + n); }
+
+		auto operator++() noexcept -> const_iterator&{ ++_index; return *this; }
+		auto operator--() noexcept -> const_iterator&{ --_index; return *this; }
+		auto operator++(int) noexcept -> const_iterator{ return {_owner, _index++}; }
+		auto operator--(int) noexcept -> const_iterator{ return {_owner, _index--}; }
+		auto operator+=(difference_type n) noexcept -> const_iterator&{
+			_index += static_cast<size_type>(n);
+			return *this;
+		}
+		auto operator-=(difference_type n) noexcept -> const_iterator&{
+			_index -= static_cast<size_type>(n);
+			return *this;
+		}
+
+		friend auto operator+(const_iterator it, difference_type n) noexcept -> const_iterator{
+			return it += n;
+		}
+		friend auto operator+(difference_type n, const_iterator it) noexcept -> const_iterator{
+			return it += n;
+		}
+		friend auto operator-(const_iterator it, difference_type n) noexcept -> const_iterator{
+			return it -= n;
+		}
+		friend auto operator-(const const_iterator& a, const const_iterator& b) noexcept
+			-> difference_type{
+			return static_cast<difference_type>(a._index - b._index);
+		}
+		friend auto operator==(const const_iterator& a, const const_iterator& b) noexcept -> bool{
+			return a._index == b._index;
+		}
+		friend auto operator<=>(const const_iterator& a, const const_iterator& b) noexcept
+			-> std::strong_ordering{
+			return a._index <=> b._index;
+		}
+
+	private:
+		const ConcurrentVec* _owner = nullptr;
+		size_type _index = 0;
+	};
+	using iterator = const_iterator;
+
+	Snapshot() noexcept = default;
+
+	auto begin() const noexcept -> const_iterator{ return {_owner, 0}; }
+	auto end() const noexcept -> const_iterator{ return {_owner, _size}; }
+	auto size() const noexcept -> size_type{ return _size; }
+	auto empty() const noexcept -> bool{ return size() == 0; }
+
+	auto operator[](size_type index) const noexcept -> const_reference{
+		assert(index < size() && "ConcurrentVec::Snapshot: Index out of bounds in operator[]");
+		return *_owner->element_at(index);
+	}
+	auto at(size_type index) const -> const_reference{
+		if(index < size()){
+			return (*this)[index];
+		}
+		throw std::out_of_range("ConcurrentVec::Snapshot: Index out of bounds in at()");
+	}
+
+	// calls f(VecView<const T>) for each contiguous run of elements, in order.
+	// That is the fast way through a snapshot: a plain loop per segment.
+	template<typename F>
+	auto for_each_segment(F&& f) const -> void{
+		for(size_type k = 0; segment_start(k) < _size; ++k){
+			const size_type count = std::min(segment_size(k), _size - segment_start(k));
+			f(VecView<const T>(elements_of(_owner->_segments[k].load(std::memory_order_acquire)),
+				count));
+		}
+	}
+
+	// a private, contiguous copy.
+	auto to_vec() const -> Vec<T> requires std::copy_constructible<T>{
+		Vec<T> result;
+		result.reserve(_size);
+		for_each_segment([&](VecView<const T> segment){
+			for(const T& element : segment){
+				result.push_back(element);
+			}
+		});
+		return result;
+	}
+
+private:
+	friend class ConcurrentVec;
+
+	Snapshot(const ConcurrentVec* owner, size_type count) noexcept
+		: _owner(owner)
+		, _size(count){}
+
+	const ConcurrentVec* _owner = nullptr;
+	size_type _size = 0;
+};
+
+#pragma warning(pop)
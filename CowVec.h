@@ -0,0 +1,218 @@
+#pragma once
+#include <atomic>
+#include <concepts>       // std::copy_constructible
+#include <cstddef>
+#include <initializer_list>
+#include <utility>        // std::exchange, std::swap
+#include "Vec.h"
+#include "VecView.h"
+
+// a plain copy of the CowVec<T> counters, taken at one point in time.
+struct CowVecStatsSnapshot{
+	size_t shares = 0;			// copies that only bumped a reference count
+	size_t deep_copies = 0;		// copies that had to copy after all, see CowVec below
+	size_t detaches = 0;		// first writes to a shared buffer, each one a deep copy
+	size_t bytes_detached = 0;	// element bytes those detaches copied
+};
+
+// one set of counters for each element type T, shared by every CowVec<T>, like VecStats.
+// Always on: they are only touched when copying or detaching, and a detach costs a deep
+// copy anyway.
+template<typename T>
+class CowVecStats{
+public:
+	static auto snapshot() noexcept -> CowVecStatsSnapshot{
+		return CowVecStatsSnapshot{
+			.shares = _shares.load(std::memory_order_relaxed),
+			.deep_copies = _deep_copies.load(std::memory_order_relaxed),
+			.detaches = _detaches.load(std::memory_order_relaxed),
+			.bytes_detached = _bytes_detached.load(std::memory_order_relaxed)
+		};
+	}
+	static auto reset() noexcept -> void{
+		_shares = 0;
+		_deep_copies = 0;
+		_detaches = 0;
+		_bytes_detached = 0;
+	}
+
+	static auto on_share() noexcept -> void{ _shares.fetch_add(1, std::memory_order_relaxed); }
+	static auto on_deep_copy() noexcept -> void{
+		_deep_copies.fetch_add(1, std::memory_order_relaxed);
+	}
+	static auto on_detach(size_t bytes) noexcept -> void{
+		_detaches.fetch_add(1, std::memory_order_relaxed);
+		_bytes_detached.fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+private:
+	static inline std::atomic<size_t> _shares{0};
+	static inline std::atomic<size_t> _deep_copies{0};
+	static inline std::atomic<size_t> _detaches{0};
+	static inline std::atomic<size_t> _bytes_detached{0};
+};
+
+// CowVec<T> is a Vec<T> whose copies share one buffer until one of them writes to it
+// ("copy on write"). Copying is O(1), one atomic increment, which suits lookup tables
+// that are handed to every worker but hardly ever changed.
+// Reading through a const CowVec never copies. Anything that can write (non-const data(),
+// begin(), operator[], push_back, ...) first "detaches": if the buffer is shared, it makes
+// a private copy of it. Note that a non-const CowVec picks the non-const overloads, even
+// just to read: use std::as_const(cow), cbegin() or view() to read without detaching.
+// Copies of one CowVec may be used on different threads; one CowVec object may not,
+// unless all of them only read, same as any other type.
+//
+// Once a writable reference, pointer or iterator has been handed out, the buffer is no
+// longer shared with anyone, ever: a later copy would otherwise see writes through it.
+// Copies of such a CowVec are deep copies (counted as deep_copies).
+template<typename T>
+class CowVec{
+	static_assert(std::copy_constructible<T>, "CowVec<T>: T must be copyable, detaching copies");
+
+public:
+	using value_type = T;
+	using iterator = typename Vec<T>::iterator;
+	using const_iterator = typename Vec<T>::const_iterator;
+	using size_type = size_t;
+	using reference = T&;
+	using const_reference = const T&;
+	using pointer = T*;
+	using const_pointer = const T*;
+
+	CowVec() noexcept = default;
+
+	// takes over the elements, no copying.
+	explicit CowVec(Vec<T>&& elements)
+		: _block(new Block(std::move(elements))){}
+
+	CowVec(std::initializer_list<T> l)
+		: CowVec(Vec<T>(l)){}
+
+	~CowVec() noexcept{
+		release();
+	}
+
+	CowVec(const CowVec& that){
+		if(!that._block){
+			return;
+		}
+		if(that._block->shareable){
+			that._block->refs.fetch_add(1, std::memory_order_relaxed);
+			_block = that._block;
+			CowVecStats<T>::on_share();
+		} else{
+			_block = new Block(that._block->elements);
+			CowVecStats<T>::on_deep_copy();
+		}
+	}
+
+	CowVec(CowVec&& that) noexcept
+		: _block(std::exchange(that._block, nullptr)){}
+
+	CowVec& operator=(const CowVec& that){
+		CowVec temp(that);
+		swap(temp);
+		return *this;
+	}
+	CowVec& operator=(CowVec&& that) noexcept{
+		swap(that);
+		return *this;
+	}
+
+	bool operator==(const CowVec& that) const noexcept requires std::equality_comparable<T>{
+		return _block == that._block || view() == that.view();
+	}
+	auto operator<=>(const CowVec& that) const noexcept requires std::three_way_comparable<T>{
+		return view() <=> that.view();
+	}
+
+	// reading: never copies.
+	auto view() const noexcept -> VecView<const T>{
+		return _block ? VecView<const T>(_block->elements) : VecView<const T>();
+	}
+	auto data() const noexcept		-> const_pointer	{ return view().data(); }
+	auto begin() const noexcept		-> const_iterator	{ return elements().begin(); }
+	auto end() const noexcept		-> const_iterator	{ return elements().end(); }
+	auto cbegin() const noexcept	-> const_iterator	{ return begin(); }
+	auto cend() const noexcept		-> const_iterator	{ return end(); }
+	auto size() const noexcept		-> size_type		{ return view().size(); }
+	auto empty() const noexcept		-> bool				{ return size() == 0; }
+	auto operator[](size_type index) const noexcept -> const_reference{ return view()[index]; }
+	auto at(size_type index) const -> const_reference	{ return elements().at(index); }
+	auto front() const noexcept		-> const_reference	{ return view().front(); }
+	auto back() const noexcept		-> const_reference	{ return view().back(); }
+
+	// writing: detaches first, and hands out something that can write.
+	auto data()						-> pointer			{ return writable().data(); }
+	auto begin()					-> iterator			{ return writable().begin(); }
+	auto end()						-> iterator			{ return writable().end(); }
+	auto operator[](size_type index) -> reference		{ return writable()[index]; }
+	auto at(size_type index)		-> reference		{ return writable().at(index); }
+	auto front()					-> reference		{ return writable().front(); }
+	auto back()						-> reference		{ return writable().back(); }
+
+	// writing, without handing out references: the buffer can still be shared later.
+	auto push_back(const T& value) -> void{
+		detached().push_back(value);
+	}
+	auto push_back(T&& value) -> void{ detached().push_back(std::move(value)); }
+	auto reserve(size_type new_cap) -> void{ detached().reserve(new_cap); }
+	auto clear() noexcept -> void{ release(); }
+
+	// how many CowVecs share our buffer, us included. 0 when we have none.
+	auto use_count() const noexcept -> size_t{
+		return _block ? _block->refs.load(std::memory_order_relaxed) : 0;
+	}
+
+	auto swap(CowVec& that) noexcept -> void{
+		std::swap(_block, that._block);
+	}
+	friend auto swap(CowVec& a, CowVec& b) noexcept -> void{
+		a.swap(b);
+	}
+
+private:
+	struct Block{
+		explicit Block(Vec<T>&& e) noexcept
+			: elements(std::move(e)){}
+		explicit Block(const Vec<T>& e)
+			: elements(e){}
+
+		std::atomic<size_t> refs{1};
+		bool shareable = true; // false once someone outside may be holding a T&
+		Vec<T> elements;
+	};
+
+	auto elements() const noexcept -> const Vec<T>&{
+		static const Vec<T> none;
+		return _block ? _block->elements : none;
+	}
+
+	// makes sure nobody else shares our buffer, copying it if they do.
+	auto detached() -> Vec<T>&{
+		if(!_block){
+			_block = new Block(Vec<T>());
+		} else if(_block->refs.load(std::memory_order_acquire) != 1){
+			Block* mine = new Block(_block->elements);
+			CowVecStats<T>::on_detach(mine->elements.size() * sizeof(T));
+			release();
+			_block = mine;
+		}
+		return _block->elements;
+	}
+	auto writable() -> Vec<T>&{
+		Vec<T>& elements = detached();
+		_block->shareable = false;
+		return elements;
+	}
+
+	// the last one out frees the buffer.
+	auto release() noexcept -> void{
+		if(_block && _block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+			delete _block;
+		}
+		_block = nullptr;
+	}
+
+	Block* _block = nullptr;
+};
@@ -0,0 +1,322 @@
+#pragma once
+#include <cassert>        // assert, catching bugs in debug builds
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>        // std::uint64_t
+#include <filesystem>
+#include <limits>         // std::numeric_limits
+#include <stdexcept>      // std::out_of_range, std::runtime_error, std::length_error
+#include <system_error>   // std::system_error, for failing OS calls
+#include <type_traits>    // std::is_trivially_copyable_v, std::remove_const_t
+#include <utility>        // std::exchange, std::swap
+#include "Vec.h"          // detail::equal_n, detail::compare_three_way_n
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>        // open
+#include <sys/mman.h>     // mmap, munmap, msync
+#include <sys/stat.h>     // fstat
+#include <unistd.h>       // close, ftruncate
+#endif
+
+#pragma warning(push)
+#pragma warning(disable : 26446) // bounds.4 - subscript operator use
+#pragma warning(disable : 26481) // bounds.1 - pointer arithmetic, we manage raw storage ourselves
+
+// MappedVec<T> looks like a Vec<T> (data, begin/end, operator[], at, ==, <=>), but its
+// elements live in a file that is memory-mapped into our address space. Opening a
+// multi-GB file is O(1): nothing is read until you touch it, and then the OS page
+// cache does the reading (and the caching, and the evicting) for us.
+//	MappedVec<const float> column("prices.f32");	// read-only view of an existing file
+//	MappedVec<float> out = MappedVec<float>::create("out.f32", n); // read-write, n zeroes
+// Writes through a MappedVec<T> go straight to the file (a shared mapping).
+// Only trivially copyable T makes sense here: the file holds bytes, not objects with
+// constructors, and the bytes are in this machine's layout and byte order.
+// The mapping can't grow, so there is no push_back. Create a bigger file instead.
+template<typename T>
+class MappedVec{
+	static_assert(std::is_trivially_copyable_v<T>,
+		"MappedVec<T> requires T to be trivially copyable, the file only holds bytes");
+
+public:
+	using value_type = std::remove_const_t<T>;
+	using iterator = T*;
+	using const_iterator = const T*;
+	using size_type = size_t;
+	using reference = T&;
+	using const_reference = const T&;
+	using pointer = T*;
+	using const_pointer = const T*;
+
+	// MappedVec<const T> maps read-only, MappedVec<T> read-write.
+	static constexpr bool writable = !std::is_const_v<T>;
+
+	MappedVec() noexcept = default;
+
+	// maps an existing file, all of it. Its size must be a whole number of T's.
+	explicit MappedVec(const std::filesystem::path& path){
+		map(path, no_resize);
+	}
+
+	// creates (or truncates) 'path' to hold 'count' zero-initialized T's, and maps it.
+	// A 'count' beyond max_size() throws std::length_error, and leaves the file alone.
+	static auto create(const std::filesystem::path& path, size_type count) -> MappedVec
+		requires writable{
+		if(count > max_count){
+			throw std::length_error("MappedVec: create() exceeds max_size()");
+		}
+		MappedVec result;
+		result.map(path, count);
+		return result;
+	}
+
+	~MappedVec() noexcept{
+		unmap();
+	}
+
+	// a mapping has exactly one owner. Copy the elements into a Vec if you need a copy.
+	MappedVec(const MappedVec&) = delete;
+	MappedVec& operator=(const MappedVec&) = delete;
+
+	MappedVec(MappedVec&& that) noexcept
+		: _data(std::exchange(that._data, nullptr))
+		, _size(std::exchange(that._size, 0)){}
+
+	MappedVec& operator=(MappedVec&& that) noexcept{
+		swap(that);
+		return *this;
+	}
+
+	bool operator==(const MappedVec& that) const noexcept requires std::equality_comparable<T>{
+		if(size() != that.size()) return false;
+		return detail::equal_n(data(), that.data(), size());
+	}
+	auto operator<=>(const MappedVec& that) const noexcept requires std::three_way_comparable<T>{
+		return detail::compare_three_way_n(data(), size(), that.data(), that.size());
+	}
+
+	auto data() noexcept		-> pointer			{ return _data; }
+	auto data() const noexcept	-> const_pointer	{ return _data; }
+
+	auto begin() noexcept		-> iterator			{ return data(); };
+	auto begin() const noexcept -> const_iterator	{ return data(); };
+
+	auto end() noexcept			-> iterator			{ return std::next(data(), size()); }
+	auto end() const noexcept	-> const_iterator	{ return std::next(data(), size()); }
+
+	auto size() const noexcept	-> size_type		{ return _size; }
+	auto empty() const noexcept -> bool				{ return size() == 0; }
+	auto max_size() const noexcept -> size_type		{ return max_count; }
+
+	auto operator[](size_type index) noexcept -> reference{
+		assert(index < size() && "MappedVec<T>: Index out of bounds in operator[]");
+		return _data[index];
+	}
+	auto operator[](size_type index) const noexcept -> const_reference{
+		assert(index < size() && "MappedVec<T>: Index out of bounds in operator[]");
+		return _data[index];
+	}
+
+	auto front() noexcept -> reference{
+		assert(!empty() && "Calling front() on an empty MappedVec is undefined behavior!");
+		return (*this)[0];
+	}
+	auto front() const noexcept -> const_reference{
+		assert(!empty() && "Calling front() on an empty MappedVec is undefined behavior!");
+		return (*this)[0];
+	}
+
+	auto back() noexcept -> reference{
+		assert(!empty() && "Calling back() on an empty MappedVec is undefined behavior!");
+		return (*this)[size() - 1];
+	}
+	auto back() const noexcept -> const_reference{
+		assert(!empty() && "Calling back() on an empty MappedVec is undefined behavior!");
+		return (*this)[size() - 1];
+	}
+
+	auto at(size_type index) -> reference{
+		if(index < size()){
+			return (*this)[index];
+		}
+		throw std::out_of_range("MappedVec<T>: Index out of bounds in at()");
+	}
+	auto at(size_type index) const -> const_reference{
+		if(index < size()){
+			return (*this)[index];
+		}
+		throw std::out_of_range("MappedVec<T>: Index out of bounds in at()");
+	}
+
+	// writes dirty pages back to the file now, rather than whenever the OS gets around to it.
+	auto flush() -> void requires writable{
+		if(empty()){
+			return;
+		}
+#if defined(_WIN32)
+		if(!::FlushViewOfFile(_data, bytes())){
+			throw_last_error("MappedVec: FlushViewOfFile failed");
+		}
+#else
+		if(::msync(_data, bytes(), MS_SYNC) != 0){
+			throw_last_error("MappedVec: msync failed");
+		}
+#endif
+	}
+
+	auto swap(MappedVec& that) noexcept -> void{
+		using std::swap;
+		swap(_data, that._data);
+		swap(_size, that._size);
+	}
+	friend auto swap(MappedVec& a, MappedVec& b) noexcept -> void{
+		a.swap(b);
+	}
+
+private:
+	static constexpr size_type no_resize = static_cast<size_type>(-1);
+	// the mapping has to fit in our address space, and the file's size in a signed
+	// 64-bit (or smaller) file offset: PTRDIFF_MAX bytes covers both.
+	static constexpr size_type max_count =
+		static_cast<size_type>(std::numeric_limits<std::ptrdiff_t>::max()) / sizeof(T);
+
+	auto bytes() const noexcept -> size_t{ return _size * sizeof(T); }
+
+	[[noreturn]] static auto throw_last_error(const char* what) -> void{
+#if defined(_WIN32)
+		throw std::system_error(static_cast<int>(::GetLastError()), std::system_category(), what);
+#else
+		throw std::system_error(errno, std::generic_category(), what);
+#endif
+	}
+
+	static auto check_size(std::uint64_t file_bytes) -> size_type{
+		if(file_bytes % sizeof(T) != 0){
+			throw std::runtime_error("MappedVec: file size is not a multiple of sizeof(T)");
+		}
+		if(file_bytes / sizeof(T) > max_count){
+			throw std::length_error("MappedVec: file is too large to map");
+		}
+		return static_cast<size_type>(file_bytes / sizeof(T));
+	}
+
+#if defined(_WIN32)
+	// RAII for a Win32 HANDLE. Once the view is mapped we can let go of both handles:
+	// the view keeps the mapping (and the file) alive until UnmapViewOfFile.
+	struct Handle{
+		HANDLE h;
+		~Handle() noexcept{
+			if(h && h != INVALID_HANDLE_VALUE){
+				::CloseHandle(h);
+			}
+		}
+	};
+
+	auto map(const std::filesystem::path& path, size_type resize_to) -> void{
+		const DWORD access = writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+		const DWORD disposition = resize_to == no_resize ? OPEN_EXISTING : CREATE_ALWAYS;
+		const Handle file{::CreateFileW(path.c_str(), access, FILE_SHARE_READ, nullptr,
+			disposition, FILE_ATTRIBUTE_NORMAL, nullptr)};
+		if(file.h == INVALID_HANDLE_VALUE){
+			throw_last_error("MappedVec: cannot open file");
+		}
+		LARGE_INTEGER file_bytes{};
+		if(resize_to != no_resize){
+			file_bytes.QuadPart = static_cast<LONGLONG>(resize_to * sizeof(T));
+			if(!::SetFilePointerEx(file.h, file_bytes, nullptr, FILE_BEGIN)
+				|| !::SetEndOfFile(file.h)){
+				throw_last_error("MappedVec: cannot resize file");
+			}
+		} else if(!::GetFileSizeEx(file.h, &file_bytes)){
+			throw_last_error("MappedVec: cannot get file size");
+		}
+		const size_type count = check_size(static_cast<std::uint64_t>(file_bytes.QuadPart));
+		if(count == 0){
+			return; // an empty file can't be mapped, and doesn't need to be
+		}
+		const Handle mapping{::CreateFileMappingW(file.h, nullptr,
+			writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr)};
+		if(!mapping.h){
+			throw_last_error("MappedVec: CreateFileMapping failed");
+		}
+		void* view = ::MapViewOfFile(mapping.h, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+		if(!view){
+			throw_last_error("MappedVec: MapViewOfFile failed");
+		}
+		_data = static_cast<pointer>(view);
+		_size = count;
+	}
+
+	auto unmap() noexcept -> void{
+		if(_data){
+			::UnmapViewOfFile(_data);
+		}
+		_data = nullptr;
+		_size = 0;
+	}
+#else
+	// RAII for a file descriptor. The mapping outlives it: munmap is all we need later.
+	struct FileDescriptor{
+		int fd;
+		~FileDescriptor() noexcept{
+			if(fd >= 0){
+				::close(fd);
+			}
+		}
+	};
+
+	auto map(const std::filesystem::path& path, size_type resize_to) -> void{
+		const int flags = resize_to == no_resize
+			? (writable ? O_RDWR : O_RDONLY)
+			: O_RDWR | O_CREAT | O_TRUNC;
+		const FileDescriptor file{::open(path.c_str(), flags | O_CLOEXEC, 0644)};
+		if(file.fd < 0){
+			throw_last_error("MappedVec: cannot open file");
+		}
+		std::uint64_t file_bytes = 0;
+		if(resize_to != no_resize){
+			file_bytes = resize_to * sizeof(T);
+			if(::ftruncate(file.fd, static_cast<off_t>(file_bytes)) != 0){
+				throw_last_error("MappedVec: cannot resize file");
+			}
+		} else{
+			struct stat info{};
+			if(::fstat(file.fd, &info) != 0){
+				throw_last_error("MappedVec: cannot get file size");
+			}
+			file_bytes = static_cast<std::uint64_t>(info.st_size);
+		}
+		const size_type count = check_size(file_bytes);
+		if(count == 0){
+			return; // mmap refuses zero-length mappings, and we don't need one
+		}
+		const int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+		void* view = ::mmap(nullptr, count * sizeof(T), protection, MAP_SHARED, file.fd, 0);
+		if(view == MAP_FAILED){
+			throw_last_error("MappedVec: mmap failed");
+		}
+		_data = static_cast<pointer>(view);
+		_size = count;
+	}
+
+	auto unmap() noexcept -> void{
+		if(_data){
+			::munmap(const_cast<value_type*>(_data), bytes());
+		}
+		_data = nullptr;
+		_size = 0;
+	}
+#endif
+
+	pointer _data = nullptr;
+	size_t _size = 0;
+};
+
+#pragma warning(pop)
@@ -0,0 +1,263 @@
+#pragma once
+#include <algorithm>      // std::max
+#include <bit>            // std::has_single_bit, std::countr_zero
+#include <cassert>        // assert, catching bugs in debug builds
+#include <cstddef>
+#include <cstdint>        // std::uintptr_t, std::uint64_t
+#include <limits>         // std::numeric_limits
+#include <new>            // std::bad_alloc, std::align_val_t
+#include <type_traits>    // std::true_type, std::false_type
+#include "Vec.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>     // mmap, munmap, madvise, mremap
+#include <unistd.h>       // sysconf
+#if defined(__linux__)
+#include <sys/syscall.h>  // SYS_mbind, so we don't need libnuma
+#endif
+#endif
+
+#pragma warning(push)
+#pragma warning(disable : 26490) // type.1 - reinterpret_cast, we do arithmetic on addresses
+
+// Where, and how, a PageAllocator gets its memory. Every field is a hint to the OS,
+// and the memory is just as usable when the OS ignores it, so a hint it can't honor is
+// silently dropped rather than failing the allocation.
+//	Vec<float, PageAllocator<float>> prices(PageAllocator<float>({
+//		.huge_pages = true, .numa = MemoryPolicy::Numa::interleave, .numa_nodes = 0b11}));
+struct MemoryPolicy{
+	enum class Numa{
+		any,		// wherever the first thread to touch a page runs (the OS default)
+		bind,		// only on the nodes in numa_nodes
+		interleave,	// round-robin over the nodes in numa_nodes, page by page
+	};
+
+	// a power of two. 64 keeps elements off their neighbors' cache lines, 4096 (or more)
+	// makes the buffer start on a page of its own.
+	size_t alignment = alignof(std::max_align_t);
+	// back the buffer with 2 MiB pages: 512 times fewer TLB entries for a large Vec.
+	// (buffers smaller than that get normal pages.)
+	bool huge_pages = false;
+	Numa numa = Numa::any;
+	std::uint64_t numa_nodes = 0; // bit i set: node i. Ignored for Numa::any.
+
+	bool operator==(const MemoryPolicy&) const = default;
+};
+
+namespace detail{
+inline constexpr size_t huge_page_size = size_t{2} << 20;
+
+inline auto page_size() noexcept -> size_t{
+#if defined(_WIN32)
+	SYSTEM_INFO info{};
+	::GetSystemInfo(&info);
+	return info.dwPageSize;
+#else
+	static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+	return size;
+#endif
+}
+
+// small, plainly aligned requests don't need the OS: operator new does them faster.
+inline auto needs_pages(const MemoryPolicy& policy) noexcept -> bool{
+	return policy.huge_pages || policy.numa != MemoryPolicy::Numa::any
+		|| policy.alignment >= page_size();
+}
+
+// a buffer smaller than a huge page would only waste most of one.
+inline auto use_huge_pages(const MemoryPolicy& policy, size_t bytes) noexcept -> bool{
+	return policy.huge_pages && bytes >= huge_page_size;
+}
+
+// what we ask the OS for: whole pages (or huge pages), never less than 'bytes'.
+inline auto mapped_size(const MemoryPolicy& policy, size_t bytes) noexcept -> size_t{
+	const size_t granule = use_huge_pages(policy, bytes) ? huge_page_size : page_size();
+	return (bytes + granule - 1) / granule * granule;
+}
+
+#if defined(_WIN32)
+inline auto map_pages(const MemoryPolicy& policy, size_t bytes) -> void*{
+	// VirtualAlloc aligns to the allocation granularity (64 KiB), and can't do better.
+	assert(policy.alignment <= 65536 && "PageAllocator: Windows can't align beyond 64 KiB");
+	const DWORD flags = MEM_RESERVE | MEM_COMMIT;
+	void* p = nullptr;
+	// large pages need the "Lock pages in memory" privilege. Without it, this fails.
+	if(use_huge_pages(policy, bytes) && ::GetLargePageMinimum() != 0
+		&& bytes % ::GetLargePageMinimum() == 0){
+		p = ::VirtualAlloc(nullptr, bytes, flags | MEM_LARGE_PAGES, PAGE_READWRITE);
+	}
+	// Windows has no interleaving, but it can prefer a node: the lowest one we were given.
+	if(!p && policy.numa != MemoryPolicy::Numa::any && policy.numa_nodes != 0){
+		const auto node = static_cast<DWORD>(std::countr_zero(policy.numa_nodes));
+		p = ::VirtualAllocExNuma(::GetCurrentProcess(), nullptr, bytes, flags,
+			PAGE_READWRITE, node);
+	}
+	if(!p){
+		p = ::VirtualAlloc(nullptr, bytes, flags, PAGE_READWRITE);
+	}
+	if(!p){
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+inline auto unmap_pages(void* p, size_t) noexcept -> void{
+	::VirtualFree(p, 0, MEM_RELEASE);
+}
+
+// Windows can't resize a mapping.
+inline auto remap_pages(const MemoryPolicy&, void*, size_t, size_t) noexcept -> void*{
+	return nullptr;
+}
+#else
+inline auto map_pages(const MemoryPolicy& policy, size_t bytes) -> void*{
+	// mmap only promises page alignment. For more, map a bit extra and trim both ends.
+	const size_t alignment = std::max({policy.alignment, page_size(),
+		use_huge_pages(policy, bytes) ? huge_page_size : size_t{0}});
+	const size_t slack = alignment - page_size();
+	if(bytes > std::numeric_limits<size_t>::max() - slack){
+		throw std::bad_alloc();
+	}
+	void* mapped = ::mmap(nullptr, bytes + slack, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(mapped == MAP_FAILED){
+		throw std::bad_alloc();
+	}
+	const auto start = reinterpret_cast<std::uintptr_t>(mapped);
+	const auto aligned = (start + alignment - 1) / alignment * alignment;
+	if(aligned != start){
+		::munmap(mapped, aligned - start);
+	}
+	if(const size_t tail = slack - (aligned - start); tail != 0){
+		::munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+	}
+	void* p = reinterpret_cast<void*>(aligned);
+
+#if defined(__linux__)
+	// both have to happen before the first touch: that is when the pages get picked.
+	if(use_huge_pages(policy, bytes)){
+		::madvise(p, bytes, MADV_HUGEPAGE);
+	}
+	if(policy.numa != MemoryPolicy::Numa::any && policy.numa_nodes != 0){
+		constexpr int mpol_bind = 2;		// from <numaif.h>
+		constexpr int mpol_interleave = 3;
+		const int mode = policy.numa == MemoryPolicy::Numa::bind ? mpol_bind : mpol_interleave;
+		const unsigned long mask = static_cast<unsigned long>(policy.numa_nodes);
+		::syscall(SYS_mbind, p, bytes, mode, &mask, sizeof(mask) * 8, 0);
+	}
+#endif
+	return p;
+}
+
+inline auto unmap_pages(void* p, size_t bytes) noexcept -> void{
+	::munmap(p, bytes);
+}
+
+// resizes a mapping from map_pages(), where it is or by moving its pages elsewhere: the
+// kernel updates the page tables, nothing gets copied. The memory policy moves along.
+// mremap only keeps page alignment though, so mappings that need more are left alone, as
+// are huge pages. nullptr if it can't, and then the old mapping is untouched.
+inline auto remap_pages(const MemoryPolicy& policy, void* p, size_t bytes, size_t new_bytes)
+	noexcept -> void*{
+#if defined(__linux__)
+	if(policy.alignment <= page_size() && !use_huge_pages(policy, bytes)
+		&& !use_huge_pages(policy, new_bytes)){
+		void* moved = ::mremap(p, bytes, new_bytes, MREMAP_MAYMOVE);
+		return moved == MAP_FAILED ? nullptr : moved;
+	}
+#endif
+	return nullptr;
+}
+#endif
+}
+
+// allocator that hands out memory according to a MemoryPolicy, chosen per instance.
+// Plain requests go to operator new. Huge pages, NUMA placement and page alignment (or
+// more) go straight to the OS, a whole number of pages at a time, so this is meant for
+// the few large Vecs that matter, not for millions of small ones.
+// The policy travels with the memory: copies, moves and swaps of the Vec take it along,
+// and two PageAllocators are equal (can free each other's memory) when their policies are.
+template<typename T>
+class PageAllocator{
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+	using is_always_equal = std::false_type;
+
+	PageAllocator() noexcept = default;
+	explicit PageAllocator(const MemoryPolicy& policy) noexcept
+		: _policy(policy){
+		assert(std::has_single_bit(policy.alignment)
+			&& "PageAllocator: alignment must be a power of two");
+	}
+	template<typename U>
+	PageAllocator(const PageAllocator<U>& that) noexcept
+		: _policy(that.policy()){}
+
+	auto policy() const noexcept -> const MemoryPolicy&{ return _policy; }
+
+	auto allocate(size_t count) -> T*{
+		if(count > std::numeric_limits<size_t>::max() / sizeof(T)){
+			throw std::bad_alloc();
+		}
+		const size_t bytes = count * sizeof(T);
+		if(detail::needs_pages(_policy)){
+			const size_t mapped = detail::mapped_size(_policy, bytes);
+			return static_cast<T*>(detail::map_pages(_policy, mapped));
+		}
+		return static_cast<T*>(::operator new(bytes, std::align_val_t{alignment()}));
+	}
+
+	// the policy and the count tell us which of the two allocate() used.
+	auto deallocate(T* p, size_t count) noexcept -> void{
+		const size_t bytes = count * sizeof(T);
+		if(detail::needs_pages(_policy)){
+			detail::unmap_pages(p, detail::mapped_size(_policy, bytes));
+		} else{
+			::operator delete(p, bytes, std::align_val_t{alignment()});
+		}
+	}
+
+	// lets Vec grow a mapped buffer without copying it, see detail::remap_pages.
+	// nullptr when that isn't possible, and then 'p' is untouched.
+	auto reallocate(T* p, size_t count, size_t new_count) noexcept -> T*{
+		if(!detail::needs_pages(_policy)
+			|| new_count > std::numeric_limits<size_t>::max() / sizeof(T)){
+			return nullptr;
+		}
+		const size_t mapped = detail::mapped_size(_policy, count * sizeof(T));
+		const size_t new_mapped = detail::mapped_size(_policy, new_count * sizeof(T));
+		if(mapped == new_mapped){
+			return p;
+		}
+		return static_cast<T*>(detail::remap_pages(_policy, p, mapped, new_mapped));
+	}
+
+	template<typename U>
+	friend bool operator==(const PageAllocator& a, const PageAllocator<U>& b) noexcept{
+		return a.policy() == b.policy();
+	}
+
+private:
+	auto alignment() const noexcept -> size_t{
+		return std::max(_policy.alignment, alignof(T));
+	}
+
+	MemoryPolicy _policy;
+};
+
+// a Vec whose memory placement you choose when you create it.
+template<typename T>
+using PageVec = Vec<T, PageAllocator<T>>;
+
+#pragma warning(pop)
@@ -0,0 +1,217 @@
+#pragma once
+#include <algorithm>      // std::max
+#include <array>
+#include <bit>            // std::bit_width
+#include <cstddef>
+#include <limits>         // std::numeric_limits
+#include <new>            // std::bad_alloc, ::operator new
+#include "Vec.h"
+
+// Recycles buffers instead of handing them back to the heap. Made for request loops that
+// create and destroy thousands of similar Vecs a second: after the first few requests,
+// allocating is popping a free list and freeing is pushing one.
+// Every thread has a pool of its own, so nothing is locked or shared. Buffers are grouped
+// by size class, powers of two from 64 bytes to max_pooled_bytes, and are always
+// allocated at their class's full size, so any pool can reuse any buffer: one allocated
+// on one thread and freed on another simply ends up in the other thread's pool.
+// Larger buffers go straight to operator new and delete.
+
+// how much a thread's pool may hold on to. Checked when a buffer comes back: one that
+// doesn't fit goes back to the heap instead.
+struct BufferPoolLimits{
+	size_t buffers_per_class = 64;			// free buffers kept for each size class
+	size_t max_buffer_bytes = 256 << 10;	// larger buffers aren't kept (<= max_pooled_bytes)
+	size_t max_cached_bytes = 8 << 20;		// all free buffers together
+};
+
+// what a thread's pool has done since the thread started (or since reset_stats()).
+struct BufferPoolStats{
+	size_t hits = 0;		// allocations served from the pool
+	size_t misses = 0;		// allocations that went to operator new
+	size_t recycled = 0;	// deallocations kept in the pool
+	size_t released = 0;	// deallocations given back to operator delete
+
+	auto hit_rate() const noexcept -> double{
+		const size_t allocations = hits + misses;
+		return allocations ? static_cast<double>(hits) / static_cast<double>(allocations) : 0.0;
+	}
+};
+
+// the pools themselves. Everything here works on the calling thread's pool.
+class BufferPool{
+public:
+	// the largest size class. Requests above this always go to the heap.
+	static constexpr size_t max_pooled_bytes = size_t{1} << 20;
+
+	static auto allocate(size_t bytes) -> void*{
+		Local* pool = local();
+		if(bytes > max_pooled_bytes){
+			if(pool){
+				++pool->stats.misses;
+			}
+			return ::operator new(bytes);
+		}
+		const size_t size_class = class_of(bytes);
+		if(pool){
+			if(FreeBuffer* buffer = pool->free[size_class]){
+				pool->free[size_class] = buffer->next;
+				--pool->cached[size_class];
+				pool->cached_bytes -= class_bytes(size_class);
+				++pool->stats.hits;
+				return buffer;
+			}
+			++pool->stats.misses;
+		}
+		return ::operator new(class_bytes(size_class));
+	}
+
+	// 'bytes' is what was asked of allocate(), which tells us the size class.
+	static auto deallocate(void* p, size_t bytes) noexcept -> void{
+		if(Local* pool = local()){
+			const size_t size_class = class_of(bytes);
+			if(bytes <= max_pooled_bytes && pool->keep(size_class)){
+				pool->free[size_class] = ::new(p) FreeBuffer{pool->free[size_class]};
+				++pool->cached[size_class];
+				pool->cached_bytes += class_bytes(size_class);
+				++pool->stats.recycled;
+				return;
+			}
+			++pool->stats.released;
+		}
+		::operator delete(p);
+	}
+
+	static auto stats() noexcept -> BufferPoolStats{
+		const Local* pool = local();
+		return pool ? pool->stats : BufferPoolStats{};
+	}
+	static auto reset_stats() noexcept -> void{
+		if(Local* pool = local()){
+			pool->stats = BufferPoolStats{};
+		}
+	}
+
+	static auto limits() noexcept -> BufferPoolLimits{
+		const Local* pool = local();
+		return pool ? pool->limits : BufferPoolLimits{};
+	}
+	// new limits start from an empty pool: whatever is cached now goes back to the heap.
+	static auto set_limits(const BufferPoolLimits& limits) noexcept -> void{
+		if(Local* pool = local()){
+			pool->trim();
+			pool->limits = limits;
+		}
+	}
+
+	// gives every free buffer back to the heap, e.g. after a burst of requests.
+	static auto trim() noexcept -> void{
+		if(Local* pool = local()){
+			pool->trim();
+		}
+	}
+
+	// how many free buffers this thread's pool holds right now.
+	static auto cached_buffers() noexcept -> size_t{
+		size_t count = 0;
+		if(const Local* pool = local()){
+			for(const size_t cached : pool->cached){
+				count += cached;
+			}
+		}
+		return count;
+	}
+
+private:
+	static constexpr size_t min_class_bytes = 64;
+	static constexpr size_t class_count = std::bit_width(max_pooled_bytes / min_class_bytes);
+
+	static constexpr auto class_of(size_t bytes) noexcept -> size_t{
+		return std::bit_width((std::max(bytes, min_class_bytes) - 1) / min_class_bytes);
+	}
+	static constexpr auto class_bytes(size_t size_class) noexcept -> size_t{
+		return min_class_bytes << size_class;
+	}
+
+	// a free buffer's first bytes link it to the next one.
+	struct FreeBuffer{
+		FreeBuffer* next;
+	};
+
+	struct Local{
+		std::array<FreeBuffer*, class_count> free{};
+		std::array<size_t, class_count> cached{};
+		size_t cached_bytes = 0;
+		BufferPoolLimits limits;
+		BufferPoolStats stats;
+
+		Local() noexcept = default;
+		Local(const Local&) = delete;
+		Local& operator=(const Local&) = delete;
+		~Local() noexcept{
+			trim();
+			t_gone = true;
+		}
+
+		auto keep(size_t size_class) const noexcept -> bool{
+			const size_t bytes = class_bytes(size_class);
+			return bytes <= limits.max_buffer_bytes
+				&& cached[size_class] < limits.buffers_per_class
+				&& cached_bytes + bytes <= limits.max_cached_bytes;
+		}
+		auto trim() noexcept -> void{
+			for(size_t size_class = 0; size_class < class_count; ++size_class){
+				while(FreeBuffer* buffer = free[size_class]){
+					free[size_class] = buffer->next;
+					::operator delete(buffer);
+				}
+				cached[size_class] = 0;
+			}
+			cached_bytes = 0;
+		}
+	};
+
+	// this thread's pool, or nullptr once it has been destroyed at thread exit: Vecs that
+	// outlive it (thread_locals created before it) then use the heap directly.
+	static auto local() noexcept -> Local*{
+		if(t_gone){
+			return nullptr;
+		}
+		thread_local Local pool;
+		return &pool;
+	}
+	static inline thread_local bool t_gone = false;
+};
+
+// allocator that gets its memory from this thread's BufferPool.
+template<typename T>
+class PoolAllocator{
+	static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+		"PoolAllocator: operator new can't align T, use AlignedAllocator or PageAllocator");
+
+public:
+	using value_type = T;
+
+	PoolAllocator() noexcept = default;
+	template<typename U>
+	PoolAllocator(const PoolAllocator<U>&) noexcept{}
+
+	auto allocate(size_t count) -> T*{
+		if(count > static_cast<size_t>(std::numeric_limits<std::ptrdiff_t>::max()) / sizeof(T)){
+			throw std::bad_alloc();
+		}
+		return static_cast<T*>(BufferPool::allocate(count * sizeof(T)));
+	}
+	auto deallocate(T* p, size_t count) noexcept -> void{
+		BufferPool::deallocate(p, count * sizeof(T));
+	}
+
+	// any pool can take any pool's buffers back.
+	template<typename U>
+	friend bool operator==(const PoolAllocator&, const PoolAllocator<U>&) noexcept{
+		return true;
+	}
+};
+
+// a Vec whose buffers are recycled by the thread's BufferPool.
+template<typename T>
+using PoolVec = Vec<T, PoolAllocator<T>>;
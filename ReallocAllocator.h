@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>        // std::malloc, std::realloc, std::free
+#include <limits>         // std::numeric_limits
+#include <new>            // std::bad_alloc
+#include "Vec.h"
+
+// allocator on top of malloc, which can also resize a buffer with realloc. For trivially
+// relocatable T, Vec uses that to grow (see is_trivially_relocatable): realloc extends the
+// buffer in place when the memory behind it is free, and for large buffers (glibc maps
+// them separately, from 128 KiB up by default) it moves the pages with mremap instead of
+// copying them. Growing a 500 MB Vec then costs a few page table updates, not a 500 MB copy.
+template<typename T>
+class ReallocAllocator{
+	static_assert(alignof(T) <= alignof(std::max_align_t),
+		"ReallocAllocator: malloc can't align T, use AlignedAllocator or PageAllocator");
+
+public:
+	using value_type = T;
+
+	ReallocAllocator() noexcept = default;
+	template<typename U>
+	ReallocAllocator(const ReallocAllocator<U>&) noexcept{}
+
+	auto allocate(size_t count) -> T*{
+		if(count > max_count){
+			throw std::bad_alloc();
+		}
+		if(void* p = std::malloc(count * sizeof(T))){
+			return static_cast<T*>(p);
+		}
+		throw std::bad_alloc();
+	}
+	auto deallocate(T* p, size_t) noexcept -> void{
+		std::free(p);
+	}
+
+	// resizes the buffer at 'p' (which holds 'count' T's) to 'new_count', moving its bytes
+	// along if it has to. nullptr if that fails, and then 'p' is still ours, untouched.
+	auto reallocate(T* p, size_t, size_t new_count) noexcept -> T*{
+		if(new_count > max_count){
+			return nullptr;
+		}
+		return static_cast<T*>(std::realloc(static_cast<void*>(p), new_count * sizeof(T)));
+	}
+
+	template<typename U>
+	friend bool operator==(const ReallocAllocator&, const ReallocAllocator<U>&) noexcept{
+		return true;
+	}
+
+private:
+	// no object may be larger than PTRDIFF_MAX bytes, so malloc won't go beyond that.
+	static constexpr size_t max_count =
+		static_cast<size_t>(std::numeric_limits<std::ptrdiff_t>::max()) / sizeof(T);
+};
+
+// a Vec that grows with realloc, when its elements are trivially relocatable.
+template<typename T>
+using ReallocVec = Vec<T, ReallocAllocator<T>>;
@@ -0,0 +1,320 @@
+#pragma once
+#include <cassert>        // assert, catching bugs in debug builds
+#include <concepts>
+#include <cstddef>        // std::byte
+#include <initializer_list>
+#include <iterator>       // std::distance
+#include <limits>         // std::numeric_limits
+#include <memory>         // std::allocator, std::uninitialized_move_n & friends, std::destroy_n
+#include <stdexcept>      // std::out_of_range, std::length_error
+#include <type_traits>
+#include <utility>        // std::swap, std::exchange
+#include "Vec.h"          // detail::equal_n, detail::compare_three_way_n
+
+#pragma warning(push)
+#pragma warning(disable : 26446) // bounds.4 - subscript operator use
+#pragma warning(disable : 26481) // bounds.1 - pointer arithmetic, we manage raw storage ourselves
+#pragma warning(disable : 26495) // type.6 - the inline buffer is left uninitialized on purpose
+
+// SmallVec<T, N> has the same interface as Vec<T>, but keeps up to N elements
+// inside the object itself. Only when it outgrows that inline buffer does it go to
+// the heap. For the many containers that never hold more than a handful of
+// elements, that means no allocation at all.
+// The price: moving a SmallVec whose elements are inline has to move each element
+// (there is no pointer to steal), so it's O(size()) and only as noexcept as T's move.
+template<typename T, size_t N>
+class SmallVec{
+	static_assert(std::is_object_v<T> && std::destructible<T>,
+		"SmallVec<T, N> requires T to be a destructible object type");
+	static_assert(N > 0, "SmallVec<T, N>: use Vec<T> if you want no inline storage");
+	static constexpr bool nothrow_move = std::is_nothrow_move_constructible_v<T>;
+
+public:
+	using value_type = T;
+	using iterator = T*;
+	using const_iterator = const T*;
+	using size_type = size_t;
+	using reference = T&;
+	using const_reference = const T&;
+	using pointer = T*;
+	using const_pointer = const T*;
+
+	static constexpr size_type inline_capacity = N;
+
+	SmallVec() noexcept = default;
+	~SmallVec() noexcept{
+		release();
+	}
+
+	// the constructors delegate to the default ctor first, so if reserve() or an
+	// element constructor throws, our destructor still cleans up after us.
+	explicit SmallVec(size_type count) requires std::default_initializable<T>
+		: SmallVec(){
+		reserve(count);
+		std::uninitialized_value_construct_n(_data, count);
+		_size = count;
+	}
+
+	SmallVec(size_type count, const value_type& val) requires std::copy_constructible<T>
+		: SmallVec(){
+		reserve(count);
+		std::uninitialized_fill_n(_data, count, val);
+		_size = count;
+	}
+
+	template<std::forward_iterator It>
+		requires std::constructible_from<T, std::iter_reference_t<It>>
+	SmallVec(It first, It last)
+		: SmallVec(){
+		const auto count = static_cast<size_type>(std::ranges::distance(first, last));
+		reserve(count);
+		std::uninitialized_copy(first, last, _data);
+		_size = count;
+	}
+
+	SmallVec(std::initializer_list<value_type> l) requires std::copy_constructible<T>
+		: SmallVec(l.begin(), l.end()){}
+
+	SmallVec(const SmallVec& that) requires std::copy_constructible<T>
+		: SmallVec(that.begin(), that.end()){}
+
+	SmallVec(SmallVec&& that) noexcept(nothrow_move)
+		: SmallVec(){
+		take(that);
+	}
+
+	SmallVec& operator=(SmallVec&& that) noexcept(nothrow_move){
+		if(this != &that){
+			release();
+			take(that);
+		}
+		return *this;
+	}
+
+	SmallVec& operator=(const SmallVec& that) requires std::copy_constructible<T>{
+		auto temp(that);
+		swap(temp);
+		return *this;
+	}
+
+	bool operator==(const SmallVec& that) const noexcept requires std::equality_comparable<T>{
+		if(size() != that.size()) return false;
+		return detail::equal_n(data(), that.data(), size());
+	}
+
+	auto operator<=>(const SmallVec& that) const noexcept requires std::three_way_comparable<T>{
+		return detail::compare_three_way_n(data(), size(), that.data(), that.size());
+	}
+
+	auto data() noexcept		-> pointer			{ return _data; }
+	auto data() const noexcept	-> const_pointer	{ return _data; }
+
+	auto begin() noexcept		-> iterator			{ return data(); };
+	auto begin() const noexcept -> const_iterator	{ return data(); };
+
+	auto end() noexcept			-> iterator			{ return std::next(data(), size()); }
+	auto end() const noexcept	-> const_iterator	{ return std::next(data(), size()); }
+
+	auto size() const noexcept	-> size_type		{ return _size; }
+	auto empty() const noexcept -> bool				{ return size() == 0; }
+	auto capacity() const noexcept -> size_type		{ return _capacity; }
+	auto max_size() const noexcept -> size_type{
+		return std::numeric_limits<size_type>::max() / sizeof(value_type);
+	}
+	// true while the elements live inside the object, not on the heap.
+	auto is_inline() const noexcept -> bool			{ return _data == inline_data(); }
+
+	// like Vec, clear() gives back the heap buffer, if we had one.
+	auto clear() noexcept		-> void				{ release(); }
+
+	auto operator[](size_type index) noexcept -> reference{
+		assert(index < size() && "SmallVec<T>: Index out of bounds in operator[]");
+		return _data[index];
+	}
+	auto operator[](size_type index) const noexcept -> const_reference{
+		assert(index < size() && "SmallVec<T>: Index out of bounds in operator[]");
+		return _data[index];
+	}
+
+	auto front() noexcept -> reference{
+		assert(!empty() && "Calling front() on an empty SmallVec is undefined behavior!");
+		return (*this)[0];
+	}
+	auto front() const noexcept -> const_reference{
+		assert(!empty() && "Calling front() on an empty SmallVec is undefined behavior!");
+		return (*this)[0];
+	}
+
+	auto back() noexcept -> reference{
+		assert(!empty() && "Calling back() on an empty SmallVec is undefined behavior!");
+		return (*this)[size() - 1];
+	}
+	auto back() const noexcept -> const_reference{
+		assert(!empty() && "Calling back() on an empty SmallVec is undefined behavior!");
+		return (*this)[size() - 1];
+	}
+
+	auto at(size_type index) -> reference{
+		if(index < size()){
+			return (*this)[index];
+		}
+		throw std::out_of_range("SmallVec<T>: Index out of bounds in at()");
+	}
+	auto at(size_type index) const -> const_reference{
+		if(index < size()){
+			return (*this)[index];
+		}
+		throw std::out_of_range("SmallVec<T>: Index out of bounds in at()");
+	}
+
+	// never shrinks, and never moves us back into the inline buffer. shrink_to_fit() does.
+	auto reserve(size_type new_cap) -> void requires std::move_constructible<T>{
+		if(new_cap <= capacity()){
+			return;
+		}
+		if(new_cap > max_size()){
+			throw std::length_error("SmallVec<T>: reserve() exceeds max_size()");
+		}
+		reallocate(new_cap);
+	}
+
+	auto shrink_to_fit() -> void requires std::move_constructible<T>{
+		if(is_inline() || capacity() == size()){
+			return;
+		}
+		reallocate(size());
+	}
+
+	auto push_back(const value_type& val) -> void requires std::copy_constructible<T>{
+		emplace_back(val);
+	}
+	auto push_back(value_type&& val) -> void{ emplace_back(std::move(val)); }
+
+	// same as Vec: build the new element before we let go of the old buffer.
+	template<typename... Args>
+		requires std::constructible_from<T, Args...> && std::move_constructible<T>
+	auto emplace_back(Args&&... args) -> reference{
+		if(size() < capacity()){
+			std::construct_at(_data + _size, std::forward<Args>(args)...);
+		} else{
+			if(capacity() == max_size()){
+				throw std::length_error("SmallVec<T>: cannot grow beyond max_size()");
+			}
+			const size_type new_cap = capacity() <= max_size() / 2 ? capacity() * 2 : max_size();
+			pointer fresh = std::allocator<value_type>{}.allocate(new_cap);
+			try{
+				std::construct_at(fresh + _size, std::forward<Args>(args)...);
+			} catch(...){
+				std::allocator<value_type>{}.deallocate(fresh, new_cap);
+				throw;
+			}
+			try{
+				relocate(_data, _size, fresh);
+			} catch(...){
+				std::destroy_at(fresh + _size);
+				std::allocator<value_type>{}.deallocate(fresh, new_cap);
+				throw;
+			}
+			adopt(fresh, new_cap);
+		}
+		++_size;
+		return back();
+	}
+
+	// two heap buffers trade places in O(1). Anything inline has to be moved.
+	auto swap(SmallVec& that) noexcept(nothrow_move) -> void{
+		if(!is_inline() && !that.is_inline()){
+			using std::swap;
+			swap(_data, that._data);
+			swap(_size, that._size);
+			swap(_capacity, that._capacity);
+			return;
+		}
+		SmallVec temp(std::move(that));
+		that = std::move(*this);
+		*this = std::move(temp);
+	}
+	friend auto swap(SmallVec& a, SmallVec& b) noexcept(nothrow_move) -> void{
+		a.swap(b);
+	}
+
+private:
+	[[gsl::suppress(type.1, "the inline buffer is raw storage for T's")]]
+	auto inline_data() noexcept -> pointer{
+		return reinterpret_cast<pointer>(&_buffer[0]);
+	}
+	[[gsl::suppress(type.1, "the inline buffer is raw storage for T's")]]
+	auto inline_data() const noexcept -> const_pointer{
+		return reinterpret_cast<const_pointer>(&_buffer[0]);
+	}
+
+	// move-constructs (or copies, if moving could throw) 'count' elements into 'dest'.
+	static auto relocate(pointer src, size_type count, pointer dest) -> void{
+		if constexpr(nothrow_move || !std::is_copy_constructible_v<value_type>){
+			std::uninitialized_move_n(src, count, dest);
+		} else{
+			std::uninitialized_copy_n(src, count, dest);
+		}
+	}
+
+	// 'fresh' (inline or heap) already holds our relocated elements. Let go of the old ones.
+	auto adopt(pointer fresh, size_type new_cap) noexcept -> void{
+		std::destroy_n(_data, _size);
+		if(!is_inline()){
+			std::allocator<value_type>{}.deallocate(_data, _capacity);
+		}
+		_data = fresh;
+		_capacity = new_cap;
+	}
+
+	// moves us to a heap buffer of 'new_cap', or back inline if that is enough.
+	auto reallocate(size_type new_cap) -> void{
+		if(new_cap <= N){
+			if(!is_inline()){
+				relocate(_data, _size, inline_data()); // noexcept for nothrow moves
+				adopt(inline_data(), N);
+			}
+			return;
+		}
+		pointer fresh = std::allocator<value_type>{}.allocate(new_cap);
+		try{
+			relocate(_data, _size, fresh);
+		} catch(...){
+			std::allocator<value_type>{}.deallocate(fresh, new_cap);
+			throw;
+		}
+		adopt(fresh, new_cap);
+	}
+
+	// destroys everything, frees the heap buffer, and goes back to the empty inline state.
+	auto release() noexcept -> void{
+		std::destroy_n(_data, _size);
+		if(!is_inline()){
+			std::allocator<value_type>{}.deallocate(_data, _capacity);
+		}
+		_data = inline_data();
+		_size = 0;
+		_capacity = N;
+	}
+
+	// requires *this to be empty and inline. Steals a heap buffer, or moves inline elements.
+	auto take(SmallVec& that) noexcept(nothrow_move) -> void{
+		assert(empty() && is_inline());
+		if(that.is_inline()){
+			std::uninitialized_move_n(that._data, that._size, _data);
+			_size = that._size;
+			that.release(); // the moved-from elements still have to be destroyed
+		} else{
+			_data = std::exchange(that._data, that.inline_data());
+			_size = std::exchange(that._size, 0);
+			_capacity = std::exchange(that._capacity, N);
+		}
+	}
+
+	alignas(T) std::byte _buffer[N * sizeof(T)];
+	pointer _data = inline_data();
+	size_t _size = 0;
+	size_t _capacity = N;
+};
+
+#pragma warning(pop)
@@ -0,0 +1,621 @@
+#pragma once
+#include <algorithm>      // std::max
+#include <array>
+#include <cassert>        // assert, catching bugs in debug builds
+#include <compare>
+#include <concepts>
+#include <cstddef>        // std::byte
+#include <initializer_list>
+#include <iterator>       // std::random_access_iterator_tag
+#include <limits>         // std::numeric_limits
+#include <memory>         // std::uninitialized_copy_n, std::uninitialized_move_n, std::destroy_n
+#include <new>            // std::align_val_t
+#include <span>
+#include <stdexcept>      // std::out_of_range, std::length_error
+#include <tuple>
+#include <type_traits>
+#include <utility>        // std::exchange, std::swap, std::index_sequence
+#include "Vec.h"          // detail::equal_n
+
+#pragma warning(push)
+#pragma warning(disable : 26446) // bounds.4 - subscript operator use
+#pragma warning(disable : 26481) // bounds.1 - pointer arithmetic, we manage raw storage ourselves
+#pragma warning(disable : 26490) // type.1 - reinterpret_cast, the buffer's bytes become columns
+
+// what iter_move gives for a row of a SoaVec: an rvalue reference to each of its fields,
+// which is all a std::tuple<Ts&&...> is. It has a type of its own only so that
+// std::common_reference can be taught about it (see below), which the standard allows for
+// our types but not for std::tuple alone.
+template<typename... Ts>
+struct SoaRvalue : std::tuple<Ts&&...>{
+	using std::tuple<Ts&&...>::tuple;
+};
+
+// A "reference" to one row of a SoaVec: a reference to each of its fields, which live
+// in different columns. Since there is no struct in memory to point at, this proxy
+// stands in for one, the way std::vector<bool>::reference stands in for a bool&.
+// Like a real reference, assigning to it assigns to what it refers to: it never rebinds.
+//	auto [id, mass] = particles[3];		// id and mass are int& and float&
+//	particles[3] = particles[4];		// copies row 4 into row 3
+//	std::tuple<int, float> row = particles[3]; // a copy of the row
+template<typename... Ts>
+class SoaRef{
+	static constexpr bool writable = (!std::is_const_v<Ts> && ...);
+
+public:
+	using value_type = std::tuple<std::remove_const_t<Ts>...>;
+
+	explicit SoaRef(Ts&... fields) noexcept
+		: _fields(fields...){}
+	SoaRef(const SoaRef&) noexcept = default;
+
+	// a row you can write converts to a row you can only read.
+	template<typename... Us> requires (!std::is_same_v<SoaRef<Us...>, SoaRef>)
+		&& (sizeof...(Us) == sizeof...(Ts)) && (std::is_convertible_v<Us&, Ts&> && ...)
+	SoaRef(const SoaRef<Us...>& that) noexcept
+		: _fields(that._fields){}
+
+	// all assignments are const: they don't change the proxy, only the row it refers to.
+	// (std::indirectly_writable insists on that.)
+	auto operator=(const SoaRef& that) const -> const SoaRef& requires writable{
+		assign(that._fields);
+		return *this;
+	}
+	auto operator=(const value_type& row) const -> const SoaRef& requires writable{
+		assign(row);
+		return *this;
+	}
+	auto operator=(value_type&& row) const -> const SoaRef& requires writable{
+		assign(std::move(row));
+		return *this;
+	}
+	// what iter_move gives: the fields of another row, to be moved from. A template, so that
+	// soa[i] = {1, 2.0f} still means value_type.
+	template<typename Row> requires writable && std::same_as<Row, SoaRvalue<Ts...>>
+	auto operator=(Row&& row) const -> const SoaRef&{
+		assign(std::move(row));
+		return *this;
+	}
+
+	// copies the row out. (Always a copy: a proxy can't tell a real rvalue from itself.)
+	operator value_type() const requires (std::copy_constructible<Ts> && ...){
+		return std::apply([](const Ts&... fields){ return value_type(fields...); }, _fields);
+	}
+	// or refers to it, as a tuple of references.
+	template<typename... Us> requires (sizeof...(Us) == sizeof...(Ts))
+		&& (std::is_convertible_v<Ts&, Us&> && ...)
+	operator std::tuple<Us&...>() const noexcept{
+		return _fields;
+	}
+
+	template<size_t I>
+	auto get() const noexcept -> std::tuple_element_t<I, std::tuple<Ts...>>&{
+		return std::get<I>(_fields);
+	}
+	template<size_t I>
+	friend auto get(const SoaRef& row) noexcept -> std::tuple_element_t<I, std::tuple<Ts...>>&{
+		return row.template get<I>();
+	}
+
+	// swaps the rows, not the proxies. By value, so it also binds to the temporaries
+	// that dereferencing a SoaVec iterator gives, which is what std::sort swaps.
+	friend auto swap(SoaRef a, SoaRef b) -> void requires writable{
+		[&]<size_t... I>(std::index_sequence<I...>){
+			using std::swap;
+			(swap(std::get<I>(a._fields), std::get<I>(b._fields)), ...);
+		}(std::index_sequence_for<Ts...>{});
+	}
+
+	// rows compare like tuples: field by field, first field first.
+	friend auto operator==(const SoaRef& a, const SoaRef& b) -> bool
+		requires (std::equality_comparable<Ts> && ...){
+		return a._fields == b._fields;
+	}
+	friend auto operator==(const SoaRef& a, const value_type& b) -> bool
+		requires (std::equality_comparable<Ts> && ...){
+		return a._fields == b;
+	}
+	friend auto operator<=>(const SoaRef& a, const SoaRef& b)
+		requires (std::three_way_comparable<Ts> && ...){
+		return a._fields <=> b._fields;
+	}
+	friend auto operator<=>(const SoaRef& a, const value_type& b)
+		requires (std::three_way_comparable<Ts> && ...){
+		return a._fields <=> b;
+	}
+
+private:
+	template<typename...>
+	friend class SoaRef;
+
+	template<typename Row>
+	auto assign(Row&& row) const -> void{
+		[&]<size_t... I>(std::index_sequence<I...>){
+			((std::get<I>(_fields) = std::get<I>(std::forward<Row>(row))), ...);
+		}(std::index_sequence_for<Ts...>{});
+	}
+
+	std::tuple<Ts&...> _fields;
+};
+
+// structured bindings: auto [a, b] = soa[i]; binds a and b to the fields themselves.
+template<typename... Ts>
+struct std::tuple_size<SoaRef<Ts...>> : std::integral_constant<size_t, sizeof...(Ts)>{};
+template<size_t I, typename... Ts>
+struct std::tuple_element<I, SoaRef<Ts...>>{
+	using type = std::tuple_element_t<I, std::tuple<Ts...>>&;
+};
+
+// what a row proxy, a tuple of its fields and a moved-from row have in common, which the
+// iterator concepts ask for: a tuple of const references, which they all convert to
+// without copying a field. So move-only fields work too. Every one of these involves a
+// type of ours: std::tuple on its own is the standard library's business.
+template<typename... Ts, typename... Us, template<typename> class TQual,
+	template<typename> class UQual> requires (sizeof...(Ts) == sizeof...(Us))
+	&& (std::same_as<std::remove_cvref_t<Us>, std::remove_const_t<Ts>> && ...)
+struct std::basic_common_reference<SoaRef<Ts...>, std::tuple<Us...>, TQual, UQual>{
+	using type = std::tuple<const Ts&...>;
+};
+template<typename... Ts, typename... Us, template<typename> class TQual,
+	template<typename> class UQual> requires (sizeof...(Ts) == sizeof...(Us))
+	&& (std::same_as<std::remove_cvref_t<Us>, std::remove_const_t<Ts>> && ...)
+struct std::basic_common_reference<std::tuple<Us...>, SoaRef<Ts...>, TQual, UQual>{
+	using type = std::tuple<const Ts&...>;
+};
+template<typename... Ts, typename... Us, template<typename> class TQual,
+	template<typename> class UQual> requires (sizeof...(Ts) == sizeof...(Us))
+	&& (std::same_as<std::remove_const_t<Us>, std::remove_const_t<Ts>> && ...)
+struct std::basic_common_reference<SoaRef<Ts...>, SoaRvalue<Us...>, TQual, UQual>{
+	using type = std::tuple<const Ts&...>;
+};
+template<typename... Ts, typename... Us, template<typename> class TQual,
+	template<typename> class UQual> requires (sizeof...(Ts) == sizeof...(Us))
+	&& (std::same_as<std::remove_const_t<Us>, std::remove_const_t<Ts>> && ...)
+struct std::basic_common_reference<SoaRvalue<Us...>, SoaRef<Ts...>, TQual, UQual>{
+	using type = std::tuple<const Ts&...>;
+};
+template<typename... Ts, typename... Us, template<typename> class TQual,
+	template<typename> class UQual> requires (sizeof...(Ts) == sizeof...(Us))
+	&& (std::same_as<std::remove_cvref_t<Us>, std::remove_const_t<Ts>> && ...)
+struct std::basic_common_reference<SoaRvalue<Ts...>, std::tuple<Us...>, TQual, UQual>{
+	using type = std::tuple<const Ts&...>;
+};
+template<typename... Ts, typename... Us, template<typename> class TQual,
+	template<typename> class UQual> requires (sizeof...(Ts) == sizeof...(Us))
+	&& (std::same_as<std::remove_cvref_t<Us>, std::remove_const_t<Ts>> && ...)
+struct std::basic_common_reference<std::tuple<Us...>, SoaRvalue<Ts...>, TQual, UQual>{
+	using type = std::tuple<const Ts&...>;
+};
+
+// random access iterator over the rows of a SoaVec: one pointer per column, and an index.
+// Its reference is a SoaRef proxy, so (like std::vector<bool>'s) it is only a random
+// access iterator in spirit for the C++17 algorithms, but std::sort is happy with it
+// (copying rows, see SoaVec), and so are the C++20 ones, which were designed with proxies
+// in mind and move rows through iter_move.
+template<typename... Ts>
+class SoaIterator{
+public:
+	using iterator_concept = std::random_access_iterator_tag;
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type = std::tuple<std::remove_const_t<Ts>...>;
+	using difference_type = std::ptrdiff_t;
+	using reference = SoaRef<Ts...>;
+	using pointer = void;
+
+	SoaIterator() noexcept = default;
+	SoaIterator(const std::tuple<Ts*...>& columns, difference_type index) noexcept
+		: _columns(columns)
+		, _index(index){}
+
+	// iterator converts to const_iterator
+	template<typename... Us> requires (!std::is_same_v<SoaIterator<Us...>, SoaIterator>)
+		&& (sizeof...(Us) == sizeof...(Ts)) && (std::is_convertible_v<Us*, Ts*> && ...)
+	SoaIterator(const SoaIterator<Us...>& that) noexcept
+		: _columns(that._columns)
+		, _index(that._index){}
+
+	auto operator*() const noexcept -> reference{
+		return std::apply([&](Ts*... columns){ return reference(columns[_index]...); }, _columns);
+	}
+	auto operator[](difference_type n) const noexcept -> reference{ return *(*this + n); }
+
+	// *it always copies (a proxy can't tell a real rvalue from itself), so the algorithms
+	// that move, std::ranges::sort, rotate and friends, ask for this instead: rvalue
+	// references to the row's fields. That moves whole rows, and makes move-only fields work.
+	friend auto iter_move(const SoaIterator& it) noexcept -> SoaRvalue<Ts...>{
+		return std::apply([&](Ts*... columns){
+			return SoaRvalue<Ts...>(std::move(columns[it._index])...);
+		}, it._columns);
+	}
+
+	auto operator++() noexcept -> SoaIterator&{ ++_index; return *this; }
+	auto operator--() noexcept -> SoaIterator&{ --_index; return *this; }
+	auto operator++(int) noexcept -> SoaIterator{ return {_columns, _index++}; }
+	auto operator--(int) noexcept -> SoaIterator{ return {_columns, _index--}; }
+	auto operator+=(difference_type n) noexcept -> SoaIterator&{ _index += n; return *this; }
+	auto operator-=(difference_type n) noexcept -> SoaIterator&{ _index -= n; return *this; }
+
+	friend auto operator+(SoaIterator it, difference_type n) noexcept -> SoaIterator{
+		return it += n;
+	}
+	friend auto operator+(difference_type n, SoaIterator it) noexcept -> SoaIterator{
+		return it += n;
+	}
+	friend auto operator-(SoaIterator it, difference_type n) noexcept -> SoaIterator{
+		return it -= n;
+	}
+	friend auto operator-(const SoaIterator& a, const SoaIterator& b) noexcept -> difference_type{
+		return a._index - b._index;
+	}
+	// iterators into different SoaVecs don't compare, just like pointers into different arrays.
+	friend auto operator==(const SoaIterator& a, const SoaIterator& b) noexcept -> bool{
+		return a._index == b._index;
+	}
+	friend auto operator<=>(const SoaIterator& a, const SoaIterator& b) noexcept
+		-> std::strong_ordering{
+		return a._index <=> b._index;
+	}
+
+private:
+	template<typename...>
+	friend class SoaIterator;
+
+	std::tuple<Ts*...> _columns{};
+	difference_type _index = 0;
+};
+
+// SoaVec<Ts...> stores rows of (Ts...) as a structure of arrays: one contiguous column
+// per field, instead of one contiguous array of structs. A scan that reads one field
+// then only pulls that field through the cache, and column<I>() hands the field's
+// elements to a SIMD kernel as a plain std::span.
+//	SoaVec<int, float, float> particles;	// id, x, y
+//	particles.emplace_back(1, 0.5f, 2.0f);
+//	for(float& x : particles.column<1>()) x += 1.0f;	// touches only the x's
+//	std::ranges::sort(particles);	// reorders whole rows, through iter_move and iter_swap
+// (std::sort works too, but it goes through the proxy: it copies rows out into value_type
+// temporaries and back in, and with libstdc++ std::ranges::sort does the same.)
+// All the columns share one allocation, each starting on its own cache line.
+template<typename... Ts>
+class SoaVec{
+	static_assert(sizeof...(Ts) > 0, "SoaVec needs at least one field");
+	static_assert(((std::is_object_v<Ts> && !std::is_const_v<Ts> && std::destructible<Ts>) && ...),
+		"SoaVec<Ts...> requires its fields to be non-const, destructible object types");
+
+	static constexpr size_t column_count = sizeof...(Ts);
+	template<size_t I>
+	using field_t = std::tuple_element_t<I, std::tuple<Ts...>>;
+	using columns_t = std::tuple<Ts*...>;
+
+public:
+	using value_type = std::tuple<Ts...>;
+	using reference = SoaRef<Ts...>;
+	using const_reference = SoaRef<const Ts...>;
+	using iterator = SoaIterator<Ts...>;
+	using const_iterator = SoaIterator<const Ts...>;
+	using size_type = size_t;
+	using difference_type = std::ptrdiff_t;
+
+	// every column starts on a multiple of this: at least a cache line, and enough for
+	// aligned 512-bit loads.
+	static constexpr size_t column_alignment = std::max({size_t{64}, alignof(Ts)...});
+
+	SoaVec() noexcept = default;
+
+	SoaVec(std::initializer_list<value_type> rows) requires (std::copy_constructible<Ts> && ...)
+		: SoaVec(reserve_only, rows.size()){
+		for(const value_type& row : rows){
+			push_back(row);
+		}
+	}
+
+	~SoaVec() noexcept{
+		release();
+	}
+
+	SoaVec(const SoaVec& that) requires (std::copy_constructible<Ts> && ...)
+		: SoaVec(reserve_only, that.size()){
+		build_columns(_columns, that.size(), [&]<size_t I>(field_t<I>* dest){
+			std::uninitialized_copy_n(std::get<I>(that._columns), that.size(), dest);
+		});
+		_size = that.size();
+	}
+
+	SoaVec(SoaVec&& that) noexcept
+		: _buffer(std::exchange(that._buffer, nullptr))
+		, _columns(std::exchange(that._columns, columns_t{}))
+		, _size(std::exchange(that._size, 0))
+		, _capacity(std::exchange(that._capacity, 0)){}
+
+	SoaVec& operator=(const SoaVec& that) requires (std::copy_constructible<Ts> && ...){
+		SoaVec temp(that);
+		swap(temp);
+		return *this;
+	}
+	SoaVec& operator=(SoaVec&& that) noexcept{
+		swap(that);
+		return *this;
+	}
+
+	// column by column, so ints and floats compare with memcmp (see detail::equal_n).
+	bool operator==(const SoaVec& that) const requires (std::equality_comparable<Ts> && ...){
+		if(size() != that.size()) return false;
+		return [&]<size_t... I>(std::index_sequence<I...>){
+			return (detail::equal_n(std::get<I>(_columns), std::get<I>(that._columns), _size)
+				&& ...);
+		}(std::index_sequence_for<Ts...>{});
+	}
+
+	// the I'th field of every row, as one contiguous span.
+	template<size_t I>
+	auto column() noexcept -> std::span<field_t<I>>{
+		return {std::get<I>(_columns), _size};
+	}
+	template<size_t I>
+	auto column() const noexcept -> std::span<const field_t<I>>{
+		return {std::get<I>(_columns), _size};
+	}
+
+	auto begin() noexcept		-> iterator			{ return {_columns, 0}; }
+	auto begin() const noexcept	-> const_iterator	{ return {const_columns(), 0}; }
+	auto end() noexcept			-> iterator			{ return begin() + ssize(); }
+	auto end() const noexcept	-> const_iterator	{ return begin() + ssize(); }
+
+	auto size() const noexcept		-> size_type	{ return _size; }
+	auto empty() const noexcept		-> bool			{ return size() == 0; }
+	auto capacity() const noexcept	-> size_type	{ return _capacity; }
+	auto max_size() const noexcept	-> size_type{
+		// each column may need up to column_alignment bytes of padding
+		constexpr size_t padding = column_count * column_alignment;
+		return (std::numeric_limits<size_t>::max() - padding) / (sizeof(Ts) + ...);
+	}
+
+	// same as Vec::clear(): destroys the rows and frees the buffer.
+	auto clear() noexcept -> void{ release(); }
+
+	auto operator[](size_type index) noexcept -> reference{
+		assert(index < size() && "SoaVec: Index out of bounds in operator[]");
+		return begin()[static_cast<difference_type>(index)];
+	}
+	auto operator[](size_type index) const noexcept -> const_reference{
+		assert(index < size() && "SoaVec: Index out of bounds in operator[]");
+		return begin()[static_cast<difference_type>(index)];
+	}
+
+	auto front() noexcept -> reference{
+		assert(!empty() && "Calling front() on an empty SoaVec is undefined behavior!");
+		return (*this)[0];
+	}
+	auto front() const noexcept -> const_reference{
+		assert(!empty() && "Calling front() on an empty SoaVec is undefined behavior!");
+		return (*this)[0];
+	}
+
+	auto back() noexcept -> reference{
+		assert(!empty() && "Calling back() on an empty SoaVec is undefined behavior!");
+		return (*this)[size() - 1];
+	}
+	auto back() const noexcept -> const_reference{
+		assert(!empty() && "Calling back() on an empty SoaVec is undefined behavior!");
+		return (*this)[size() - 1];
+	}
+
+	auto at(size_type index) -> reference{
+		if(index < size()){
+			return (*this)[index];
+		}
+		throw std::out_of_range("SoaVec: Index out of bounds in at()");
+	}
+	auto at(size_type index) const -> const_reference{
+		if(index < size()){
+			return (*this)[index];
+		}
+		throw std::out_of_range("SoaVec: Index out of bounds in at()");
+	}
+
+	// Strong guarantee: if anything throws, *this is left untouched.
+	auto reserve(size_type new_cap) -> void{
+		if(new_cap <= capacity()){
+			return;
+		}
+		if(new_cap > max_size()){
+			throw std::length_error("SoaVec: reserve() exceeds max_size()");
+		}
+		Storage fresh = allocate(new_cap);
+		try{
+			relocate_to(fresh.columns);
+		} catch(...){
+			deallocate(fresh.buffer, new_cap);
+			throw;
+		}
+		adopt(fresh, new_cap);
+	}
+
+	auto push_back(const value_type& row) -> void requires (std::copy_constructible<Ts> && ...){
+		std::apply([&](const Ts&... fields){ emplace_back(fields...); }, row);
+	}
+	auto push_back(value_type&& row) -> void{
+		std::apply([&](Ts&... fields){ emplace_back(std::move(fields)...); }, row);
+	}
+
+	// one argument per field. As with Vec, the new row is built before the old buffer is
+	// touched, so soa.emplace_back(soa[0].get<0>(), ...) is safe even when it reallocates.
+	template<typename... Args>
+		requires (sizeof...(Args) == column_count) && (std::constructible_from<Ts, Args> && ...)
+	auto emplace_back(Args&&... fields) -> reference{
+		if(size() < capacity()){
+			construct_row(_columns, _size, std::forward_as_tuple(std::forward<Args>(fields)...));
+		} else{
+			const size_type new_cap = next_capacity();
+			Storage fresh = allocate(new_cap);
+			try{
+				construct_row(fresh.columns, _size,
+					std::forward_as_tuple(std::forward<Args>(fields)...));
+			} catch(...){
+				deallocate(fresh.buffer, new_cap);
+				throw;
+			}
+			try{
+				relocate_to(fresh.columns);
+			} catch(...){
+				destroy_row(fresh.columns, _size);
+				deallocate(fresh.buffer, new_cap);
+				throw;
+			}
+			adopt(fresh, new_cap);
+		}
+		++_size;
+		return back();
+	}
+
+	auto swap(SoaVec& that) noexcept -> void{
+		using std::swap;
+		swap(_buffer, that._buffer);
+		swap(_columns, that._columns);
+		swap(_size, that._size);
+		swap(_capacity, that._capacity);
+	}
+	friend auto swap(SoaVec& a, SoaVec& b) noexcept -> void{
+		a.swap(b);
+	}
+
+private:
+	struct reserve_only_t{};
+	static constexpr reserve_only_t reserve_only{};
+
+	struct Storage{
+		std::byte* buffer;
+		columns_t columns;
+	};
+
+	// allocates room for 'count' rows, but constructs none of them.
+	SoaVec(reserve_only_t, size_type count){
+		if(count > max_size()){
+			throw std::length_error("SoaVec: allocation exceeds max_size()");
+		}
+		const Storage storage = allocate(count);
+		_buffer = storage.buffer;
+		_columns = storage.columns;
+		_capacity = count;
+	}
+
+	auto ssize() const noexcept -> difference_type{ return static_cast<difference_type>(_size); }
+
+	auto const_columns() const noexcept -> std::tuple<const Ts*...>{ return _columns; }
+
+	// where each column starts, for 'capacity' rows. The last entry is the total size.
+	static auto layout(size_type capacity) noexcept -> std::array<size_t, column_count + 1>{
+		std::array<size_t, column_count + 1> offsets{};
+		size_t offset = 0;
+		size_t column = 0;
+		((offsets[column++] = offset,
+			offset += (capacity * sizeof(Ts) + column_alignment - 1) / column_alignment
+				* column_alignment), ...);
+		offsets[column_count] = offset;
+		return offsets;
+	}
+
+	// one allocation, carved up into the columns.
+	static auto allocate(size_type capacity) -> Storage{
+		if(capacity == 0){
+			return {nullptr, columns_t{}};
+		}
+		const auto offsets = layout(capacity);
+		auto* buffer = static_cast<std::byte*>(
+			::operator new(offsets[column_count], std::align_val_t{column_alignment}));
+		return {buffer, [&]<size_t... I>(std::index_sequence<I...>){
+			return columns_t{reinterpret_cast<Ts*>(buffer + offsets[I])...};
+		}(std::index_sequence_for<Ts...>{})};
+	}
+	static auto deallocate(std::byte* buffer, size_type capacity) noexcept -> void{
+		if(buffer){
+			::operator delete(buffer, layout(capacity)[column_count],
+				std::align_val_t{column_alignment});
+		}
+	}
+
+	// calls build.operator()<I>(column I of 'dest') for every column, in order. Each call
+	// constructs 'count' elements, or throws having constructed none. If one throws,
+	// the columns built before it are destroyed again.
+	template<size_t I = 0, typename Build>
+	static auto build_columns(const columns_t& dest, size_type count, Build&& build) -> void{
+		if constexpr(I < column_count){
+			build.template operator()<I>(std::get<I>(dest));
+			try{
+				build_columns<I + 1>(dest, count, build);
+			} catch(...){
+				std::destroy_n(std::get<I>(dest), count);
+				throw;
+			}
+		}
+	}
+
+	// constructs field I of row 'index' from std::get<I>(args), and so on for the rest.
+	template<size_t I = 0, typename Args>
+	static auto construct_row(const columns_t& dest, size_type index, Args&& args) -> void{
+		if constexpr(I < column_count){
+			std::construct_at(std::get<I>(dest) + index, std::get<I>(std::forward<Args>(args)));
+			try{
+				construct_row<I + 1>(dest, index, std::forward<Args>(args));
+			} catch(...){
+				std::destroy_at(std::get<I>(dest) + index);
+				throw;
+			}
+		}
+	}
+	static auto destroy_row(const columns_t& dest, size_type index) noexcept -> void{
+		std::apply([&](Ts*... columns){ (std::destroy_at(columns + index), ...); }, dest);
+	}
+
+	// moves our rows into 'dest', or copies them when moving could throw (and copying can
+	// be done), which keeps the strong guarantee. See Vec::relocate_n.
+	// Decided for the whole row, like std::move_if_noexcept would for a struct: moving one
+	// column and then throwing while copying the next would leave the moved one gutted.
+	static constexpr bool move_rows =
+		((std::is_nothrow_move_constructible_v<Ts> || !std::copy_constructible<Ts>) && ...);
+
+	auto relocate_to(const columns_t& dest) -> void{
+		build_columns(dest, _size, [&]<size_t I>(field_t<I>* column){
+			if constexpr(move_rows){
+				std::uninitialized_move_n(std::get<I>(_columns), _size, column);
+			} else{
+				std::uninitialized_copy_n(std::get<I>(_columns), _size, column);
+			}
+		});
+	}
+
+	auto destroy_all() noexcept -> void{
+		std::apply([&](Ts*... columns){ (std::destroy_n(columns, _size), ...); }, _columns);
+	}
+
+	// the old rows have been relocated into 'fresh': destroy them, and move in.
+	auto adopt(const Storage& fresh, size_type new_cap) noexcept -> void{
+		destroy_all();
+		deallocate(_buffer, _capacity);
+		_buffer = fresh.buffer;
+		_columns = fresh.columns;
+		_capacity = new_cap;
+	}
+
+	auto release() noexcept -> void{
+		destroy_all();
+		deallocate(_buffer, _capacity);
+		_buffer = nullptr;
+		_columns = columns_t{};
+		_size = 0;
+		_capacity = 0;
+	}
+
+	auto next_capacity() const -> size_type{
+		if(capacity() >= max_size()){
+			throw std::length_error("SoaVec: cannot grow beyond max_size()");
+		}
+		return capacity() < max_size() / 2 ? std::max<size_type>(2 * capacity(), 1) : max_size();
+	}
+
+	std::byte* _buffer = nullptr;
+	columns_t _columns{};
+	size_t _size = 0;
+	size_t _capacity = 0;
+};
+
+#pragma warning(pop)
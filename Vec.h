@@ -0,0 +1,1344 @@
+#pragma once
+#include <algorithm>      // std::equal, std::lexicographical_compare_three_way
+#include <cassert>        // assert, catching bugs in debug builds
+#include <compare>        // three-way comparison
+#include <concepts>       // std::copy_constructible, std::three_way_comparable, ...
+#include <cstddef>        // std::byte
+#include <cstring>        // std::memcpy, std::memmove, std::memcmp
+#include <initializer_list>
+#include <iterator>       // std::distance
+#include <limits>         // std::numeric_limits
+#include <memory>         // std::allocator_traits, std::uninitialized_copy & friends, std::destroy
+#include <memory_resource> // std::pmr::polymorphic_allocator
+#include <ranges>         // std::ranges::input_range, for the *_range members
+#include <ratio>          // std::ratio, for the growth factor
+#include <stdexcept>      // std::out_of_range, std::length_error
+#include <type_traits>    // std::is_trivially_copyable_v, std::is_nothrow_move_constructible_v
+#include <utility>        // std::swap, std::exchange, std::cmp_less_equal
+
+#pragma warning(push)
+#pragma warning(disable : 26446) // bounds.4 - subscript operator use
+#pragma warning(disable : 26481) // bounds.1 - pointer arithmetic, we manage raw storage ourselves
+
+// tag to ask for default-initialized elements instead of value-initialized ones.
+// For trivial types (int, float, std::byte...) that means the memory is left
+// untouched, so a buffer you are about to overwrite isn't zeroed first.
+struct default_init_t{
+	explicit default_init_t() = default;
+};
+inline constexpr default_init_t default_init{};
+
+// tag for the constructor from a range: Vec<Record> records(from_range, parse(input));
+// This is C++23's std::from_range when the standard library has it, so that works too.
+#if defined(__cpp_lib_containers_ranges)
+using std::from_range_t;
+using std::from_range;
+#else
+struct from_range_t{
+	explicit from_range_t() = default;
+};
+inline constexpr from_range_t from_range{};
+#endif
+
+// customization point: is it safe to move a T to another address by copying its bytes,
+// and then simply forget about the original? True for trivially copyable types, and for
+// most others too (std::unique_ptr, std::string on most libraries...), but not for a type
+// that points into itself or registers its address somewhere. Opt your own types in with
+//	template<> struct is_trivially_relocatable<Widget> : std::true_type{};
+// and Vec grows them with a memcpy, or lets the allocator move the pages (see reallocate).
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T>{};
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+namespace detail{
+// the policy overloads, in VecParallel.h
+struct vec_parallel;
+
+// the alignment an allocator promises for everything it allocates: its static
+// 'alignment' member if it has one, alignof(value_type) if not.
+template<typename Alloc>
+inline constexpr size_t allocator_alignment = alignof(typename Alloc::value_type);
+template<typename Alloc> requires requires{ { Alloc::alignment } -> std::convertible_to<size_t>; }
+inline constexpr size_t allocator_alignment<Alloc> = Alloc::alignment;
+
+// element types for which == means "same bytes": integers, enums (so std::byte) and
+// pointers. Floating point doesn't qualify (0.0 == -0.0, but NaN != NaN), and neither
+// do class types, whose operator== may skip padding or compare something else entirely.
+template<typename T>
+concept bytewise_equality_comparable =
+	std::is_scalar_v<T> && std::has_unique_object_representations_v<T>;
+
+// compares two arrays of 'count' elements each. For bytewise comparable T we hand the
+// whole thing to memcmp, which every standard library implements with wide SIMD loads.
+// Everyone else gets the element-by-element loop.
+template<typename T>
+auto equal_n(const T* a, const T* b, size_t count) -> bool{
+	if constexpr(bytewise_equality_comparable<T>){
+		return count == 0 || a == b || std::memcmp(a, b, count * sizeof(T)) == 0;
+	} else{
+		return std::equal(a, a + count, b);
+	}
+}
+
+// single-byte types whose order is the order of their unsigned bytes. That is exactly
+// what memcmp compares, so it can order them all on its own. (plain char may be signed.)
+template<typename T>
+concept bytewise_orderable = bytewise_equality_comparable<T> && sizeof(T) == 1
+	&& (std::is_same_v<T, std::byte> || std::is_same_v<T, bool> || std::is_same_v<T, unsigned char>
+		|| std::is_same_v<T, char8_t>);
+
+// lexicographical three-way comparison of [a, a + a_count) and [b, b + b_count).
+// Same result, and same ordering category, as std::lexicographical_compare_three_way.
+// Unsigned bytes are ordered by memcmp outright. Other bytewise comparable types use
+// memcmp to skip over equal blocks, and only compare the first differing element.
+template<typename T>
+auto compare_three_way_n(const T* a, size_t a_count, const T* b, size_t b_count)
+	-> std::compare_three_way_result_t<T>{
+	const size_t common = std::min(a_count, b_count);
+	if constexpr(bytewise_orderable<T>){
+		const int result = common ? std::memcmp(a, b, common) : 0;
+		return result != 0 ? result <=> 0 : a_count <=> b_count;
+	} else if constexpr(bytewise_equality_comparable<T>){
+		constexpr size_t block = std::max<size_t>(1, 256 / sizeof(T));
+		size_t i = 0;
+		while(i + block <= common && std::memcmp(a + i, b + i, block * sizeof(T)) == 0){
+			i += block;
+		}
+		for(; i < common; ++i){
+			if(a[i] != b[i]){
+				return std::compare_three_way{}(a[i], b[i]);
+			}
+		}
+		return a_count <=> b_count;
+	} else{
+		return std::lexicographical_compare_three_way(a, a + a_count, b, b + b_count);
+	}
+}
+}
+
+// empty allocators (std::allocator and friends) shouldn't cost us any bytes.
+// MSVC accepts, but silently ignores, the standard spelling of the attribute.
+#if defined(_MSC_VER)
+#define VEC_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define VEC_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+// debug builds hand out checked iterators, release builds plain pointers.
+// Define VEC_CHECKED_ITERATORS to 0 or 1 yourself to override, but do it the same way
+// in every translation unit: it changes the layout of Vec.
+#if !defined(VEC_CHECKED_ITERATORS)
+#if defined(NDEBUG)
+#define VEC_CHECKED_ITERATORS 0
+#else
+#define VEC_CHECKED_ITERATORS 1
+#endif
+#endif
+
+#if VEC_CHECKED_ITERATORS
+namespace detail{
+// a pointer that knows which Vec it points into, and the Vec's generation when it was
+// made. Vec bumps its generation whenever iterators into it stop being valid (it
+// reallocated, shifted elements around, was cleared, swapped or moved from), so a stale
+// iterator asserts instead of quietly reading freed memory. Dereferencing checks the
+// bounds too.
+// It still is a contiguous_iterator: std::to_address gives the raw pointer back, so
+// algorithms that care (and Vec's own memcpy paths) can drop down to that.
+// A destroyed Vec can't be detected this way. That is what the address sanitizer is for.
+// The same goes for a Vec that moved: the iterator remembers the Vec object, not its
+// buffer. When a Vec<Vec<T>> reallocates, its inner Vecs are moved to new addresses and
+// the old ones destroyed, and iterators into them must be taken again, even though the
+// buffers they point into stayed put and plain pointers (the standard) would be fine.
+template<typename Owner, typename Elem>
+class checked_iterator{
+public:
+	using iterator_concept = std::contiguous_iterator_tag;
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type = std::remove_cv_t<Elem>;
+	using element_type = Elem;
+	using difference_type = std::ptrdiff_t;
+	using pointer = Elem*;
+	using reference = Elem&;
+
+	checked_iterator() noexcept = default;
+	checked_iterator(const Owner* owner, pointer p) noexcept
+		: _owner(owner)
+		, _ptr(p)
+		, _generation(owner->_generation){}
+
+	// iterator converts to const_iterator
+	template<typename Other> requires std::is_convertible_v<Other*, Elem*>
+		&& (!std::is_same_v<Other, Elem>)
+	checked_iterator(const checked_iterator<Owner, Other>& that) noexcept
+		: _owner(that._owner)
+		, _ptr(that._ptr)
+		, _generation(that._generation){}
+
+	// false once the Vec has invalidated this iterator, and for value-initialized ones.
+	// What the asserts below check, for code (and tests) that would rather ask than abort.
+	auto valid() const noexcept -> bool{
+		return _owner && _owner->_generation == _generation;
+	}
+
+	auto operator*() const noexcept -> reference{
+		assert_dereferenceable();
+		return *_ptr;
+	}
+	// also used by std::to_address, on end() too, so this one doesn't check the bounds.
+	auto operator->() const noexcept -> pointer{
+		assert_valid();
+		return _ptr;
+	}
+	auto operator[](difference_type n) const noexcept -> reference{
+		return *(*this + n);
+	}
+
+	auto operator++() noexcept -> checked_iterator&{ return *this += 1; }
+	auto operator--() noexcept -> checked_iterator&{ return *this -= 1; }
+	auto operator++(int) noexcept -> checked_iterator{
+		checked_iterator old = *this;
+		++*this;
+		return old;
+	}
+	auto operator--(int) noexcept -> checked_iterator{
+		checked_iterator old = *this;
+		--*this;
+		return old;
+	}
+
+	auto operator+=(difference_type n) noexcept -> checked_iterator&{
+		if(n != 0){
+			assert_valid();
+			const auto index = (_ptr - _owner->_data) + n;
+			assert(index >= 0 && static_cast<size_t>(index) <= _owner->_size
+				&& "Vec<T>: iterator moved out of range");
+			_ptr += n;
+		}
+		return *this;
+	}
+	auto operator-=(difference_type n) noexcept -> checked_iterator&{ return *this += -n; }
+
+	friend auto operator+(checked_iterator it, difference_type n) noexcept -> checked_iterator{
+		return it += n;
+	}
+	friend auto operator+(difference_type n, checked_iterator it) noexcept -> checked_iterator{
+		return it += n;
+	}
+	friend auto operator-(checked_iterator it, difference_type n) noexcept -> checked_iterator{
+		return it -= n;
+	}
+	friend auto operator-(const checked_iterator& a, const checked_iterator& b) noexcept
+		-> difference_type{
+		a.assert_comparable(b);
+		return a._ptr - b._ptr;
+	}
+
+	friend auto operator==(const checked_iterator& a, const checked_iterator& b) noexcept -> bool{
+		a.assert_comparable(b);
+		return a._ptr == b._ptr;
+	}
+	friend auto operator<=>(const checked_iterator& a, const checked_iterator& b) noexcept
+		-> std::strong_ordering{
+		a.assert_comparable(b);
+		return std::compare_three_way{}(a._ptr, b._ptr);
+	}
+
+private:
+	template<typename, typename>
+	friend class checked_iterator;
+
+	auto assert_valid() const noexcept -> void{
+		assert(_owner && "Vec<T>: using a singular (default-constructed) iterator");
+		assert(valid()
+			&& "Vec<T>: using an iterator invalidated by reallocation, insert, erase, clear, ...");
+	}
+	auto assert_dereferenceable() const noexcept -> void{
+		assert_valid();
+		assert(_ptr >= _owner->_data && _ptr < _owner->_data + _owner->_size
+			&& "Vec<T>: dereferencing an out of range iterator");
+	}
+	// default-constructed iterators compare equal to each other, and only to each other.
+	auto assert_comparable(const checked_iterator& that) const noexcept -> void{
+		assert(_owner == that._owner && "Vec<T>: comparing iterators into different Vecs");
+		if(_owner){
+			assert_valid();
+			that.assert_valid();
+		}
+	}
+
+	const Owner* _owner = nullptr;
+	pointer _ptr = nullptr;
+	size_t _generation = 0;
+};
+}
+#endif
+
+// Alloc is any standard-conforming allocator for T. All memory, and all element
+// construction, goes through std::allocator_traits<Alloc>, which also tells us whether
+// the allocator follows its elements on copy, move and swap (the propagate_* traits).
+// GrowthFactor decides how much the capacity grows when push_back runs out of room.
+// Geometric growth is what makes appending amortized O(1): a million push_backs
+// cost ~20 reallocations with a factor of 2, instead of a million copies.
+// Pass e.g. std::ratio<3, 2> to trade a few more reallocations for less slack.
+template<typename T, typename Alloc = std::allocator<T>, typename GrowthFactor = std::ratio<2>>
+class Vec{
+	using alloc_traits = std::allocator_traits<Alloc>;
+
+	// Vec only insists on what every operation needs: a destructible object type.
+	// Everything else is asked for by the members that need it (see the requires-clauses),
+	// so Vec<std::unique_ptr<X>> works, it just isn't copyable. Vec<T> is regular exactly
+	// when T is.
+	static_assert(std::is_object_v<T> && std::destructible<T>,
+		"Vec<T> requires T to be a destructible object type");
+	static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+		"Vec<T, Alloc> requires Alloc::value_type to be T");
+	static_assert(std::is_same_v<typename alloc_traits::pointer, T*>,
+		"Vec<T, Alloc> does not support fancy pointers");
+	static_assert(GrowthFactor::num > GrowthFactor::den, "Vec<T>: GrowthFactor must be > 1");
+
+	// (these come first, the requires-clauses of the public members below need them.)
+
+	// when the allocator has no construct() or destroy() of its own (std::allocator and
+	// most custom ones), constructing an element just means placement-new. Then we are
+	// free to use the std::uninitialized_* algorithms, and memcpy for trivially copyable
+	// T. std::pmr only customizes construction for types that use allocators themselves.
+	static constexpr bool plain_construct =
+		(!requires(Alloc& a, T* p, const T& v){ a.construct(p, v); }
+			&& !requires(Alloc& a, T* p){ a.destroy(p); })
+		|| (std::is_same_v<Alloc, std::pmr::polymorphic_allocator<T>>
+			&& !std::uses_allocator_v<T, Alloc>);
+	static constexpr bool memcpy_construct = plain_construct && std::is_trivially_copyable_v<T>;
+	// trivially relocatable elements move to a new buffer as bytes, and the old ones are
+	// then just forgotten, not destroyed. That includes letting the allocator move them:
+	// one with a 'T* reallocate(T* p, size_t count, size_t new_count)' of its own can
+	// resize a buffer without us copying anything (ReallocAllocator, PageAllocator).
+	static constexpr bool memcpy_relocate = plain_construct && is_trivially_relocatable_v<T>;
+	static constexpr bool realloc_relocate = memcpy_relocate
+		&& requires(Alloc& a, T* p, size_t n){ { a.reallocate(p, n, n) } -> std::same_as<T*>; };
+
+	// inserting and erasing in the middle shift elements around: as bytes, or by moving
+	// them (which needs assignment too, see insert_with).
+	static constexpr bool shiftable =
+		std::move_constructible<T> && (memcpy_relocate || std::movable<T>);
+
+public:
+	using value_type = T;
+	using allocator_type = Alloc;
+#if VEC_CHECKED_ITERATORS
+	using iterator = detail::checked_iterator<Vec, T>;
+	using const_iterator = detail::checked_iterator<Vec, const T>;
+#else
+	using iterator = T*;
+	using const_iterator = const T*;
+#endif
+	using size_type = size_t;
+	using reference = T&;
+	using const_reference = const T&;
+	using pointer = T*;
+	using const_pointer = const T*;
+
+	// data() always starts on a multiple of this. Usually that is just alignof(T), but an
+	// allocator can promise more (AlignedAllocator does), and then data() tells the
+	// compiler too, so loops over it can use aligned SIMD loads.
+	static constexpr size_t alignment = detail::allocator_alignment<Alloc>;
+
+	Vec() noexcept(noexcept(Alloc())) = default;
+
+	explicit Vec(const Alloc& alloc) noexcept
+		: _alloc(alloc){}
+
+	// we own raw storage now, so the destructor has two jobs:
+	// end the lifetime of every live element, then hand the memory back.
+	~Vec() noexcept{
+		release();
+	}
+	
+	// all public constructors below construct their elements straight into raw storage,
+	// exactly once. They delegate the allocation to the private reserving ctor, which
+	// makes *this a fully constructed (empty) object. So if an element constructor
+	// throws, our destructor runs and frees the buffer. No leaks, no try/catch needed.
+	// Our construct helpers roll back whatever they managed to construct.
+
+	// count constructor, 'count' value-initialized T's (ints are zeroed).
+	explicit Vec(size_type count, const Alloc& alloc = Alloc())
+		requires std::default_initializable<T>
+		: Vec(reserve_only, count, alloc){
+		value_construct_n(_data, count);
+		_size = count;
+	}
+
+	// default-init count constructor, 'count' default-initialized T's.
+	// Trivial types are left indeterminate: you must write before you read!
+	// (an allocator with its own construct() only knows how to value-initialize, so
+	// with one of those, such as std::pmr, this is the same as the count ctor.)
+	Vec(size_type count, default_init_t, const Alloc& alloc = Alloc())
+		requires std::default_initializable<T>
+		: Vec(reserve_only, count, alloc){
+		if constexpr(plain_construct){
+			std::uninitialized_default_construct_n(_data, count);
+		} else{
+			construct_n(_data, count, [&](pointer p, size_type){
+				alloc_traits::construct(_alloc, p);
+			});
+		}
+		_size = count;
+	}
+
+	// fill constructor: constructs 'count' copies of 'val'
+	Vec(size_type count, const value_type& val, const Alloc& alloc = Alloc())
+		requires std::copy_constructible<T>
+		: Vec(reserve_only, count, alloc){
+		fill_construct_n(_data, count, val);
+		_size = count;
+	}
+
+	// range constructor, accepting a pair of forward iterators
+	// notice that we are constraining the template parameter using a concept!
+	template<std::forward_iterator It>
+		requires std::constructible_from<T, std::iter_reference_t<It>>
+	Vec(It first, It last, const Alloc& alloc = Alloc())
+		: Vec(reserve_only, static_cast<size_type>(std::ranges::distance(first, last)), alloc){
+		copy_construct(first, last, _data);
+		_size = _capacity;
+	}
+
+	// ... and a pair of single-pass input iterators (std::istream_iterator). There is no
+	// telling how many elements are coming, so they are appended as they arrive, growing
+	// geometrically like push_back does.
+	template<std::input_iterator It>
+		requires (!std::forward_iterator<It>)
+			&& std::constructible_from<T, std::iter_reference_t<It>> && std::move_constructible<T>
+	Vec(It first, It last, const Alloc& alloc = Alloc())
+		: Vec(alloc){
+		for(; first != last; ++first){
+			emplace_back(*first);
+		}
+	}
+
+	// construct from any input range, read exactly once. A range that knows its size (or
+	// can be measured, being a forward range) is built in a single allocation; anything
+	// else, a generator or std::views::istream, streams in like the constructor above.
+	template<std::ranges::input_range R>
+		requires std::constructible_from<T, std::ranges::range_reference_t<R>>
+			&& std::move_constructible<T>
+	Vec(from_range_t, R&& range, const Alloc& alloc = Alloc())
+		: Vec(alloc){
+		append_range(std::forward<R>(range));
+	}
+
+	Vec(std::initializer_list<value_type> l, const Alloc& alloc = Alloc())
+		requires std::copy_constructible<T>
+		: Vec(l.begin(), l.end(), alloc) // delegate to the range ctor
+	{}
+
+	// copy ctor. The allocator gets a say in what the copy is allocated with.
+	Vec(const Vec& that) requires std::copy_constructible<T>
+		: Vec(that.data(), std::next(that.data(), that.size()),
+			alloc_traits::select_on_container_copy_construction(that._alloc)){}
+
+	// allocator-extended copy ctor, lets e.g. std::pmr put the copy in another arena.
+	Vec(const Vec& that, const Alloc& alloc) requires std::copy_constructible<T>
+		: Vec(that.data(), std::next(that.data(), that.size()), alloc){}
+
+	// move ctor. The allocator always moves along with the buffer it allocated.
+	Vec(Vec&& that) noexcept
+		: _alloc(std::move(that._alloc))
+		, _data(std::exchange(that._data, nullptr))
+		, _size(std::exchange(that._size, 0))
+		, _capacity(std::exchange(that._capacity, 0)){
+		that.invalidate_iterators();
+	}
+
+	// allocator-extended move ctor. Only steals the buffer if 'alloc' can free it,
+	// otherwise it has to move the elements one by one into memory of its own.
+	Vec(Vec&& that, const Alloc& alloc)
+		: _alloc(alloc){
+		if(_alloc == that._alloc){
+			steal_storage(that);
+		} else{
+			Vec temp(reserve_only, that.size(), alloc);
+			temp.move_construct(that.data(), that.size(), temp._data);
+			temp._size = that.size();
+			swap_storage(temp);
+		}
+	}
+
+	// move assignment is still (mostly) a swap. But if the allocator doesn't propagate,
+	// and the two allocators can't free each other's memory, we have no choice but
+	// to move the elements into our own memory, one at a time. That may throw.
+	Vec& operator=(Vec&& that) noexcept(alloc_traits::propagate_on_container_move_assignment::value
+		|| alloc_traits::is_always_equal::value){
+		if constexpr(alloc_traits::propagate_on_container_move_assignment::value){
+			release();
+			_alloc = std::move(that._alloc);
+			steal_storage(that);
+		} else{
+			if(_alloc == that._alloc){
+				swap_storage(that);
+			} else{
+				Vec temp(std::move(that), _alloc);
+				swap_storage(temp);
+			}
+		}
+		return *this;
+	}
+
+	// copy-and-swap. 'temp' is built with the allocator we want to end up with, so if
+	// anything throws we haven't touched *this: the strong guarantee.
+	Vec& operator=(const Vec& that) requires std::copy_constructible<T>{
+		constexpr bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+		Vec temp(that.data(), std::next(that.data(), that.size()),
+			propagate ? that._alloc : _alloc);
+		if constexpr(propagate){
+			release(); // our old buffer must be freed by the allocator that made it
+			_alloc = temp._alloc;
+		}
+		swap_storage(temp);
+		return *this;
+	}
+
+	//equality operator, to satisfy std::regular (when T is equality comparable)
+	// (for ints, bytes and friends this compiles down to a single memcmp)
+	bool operator==(const Vec& that) const noexcept requires std::equality_comparable<T>{
+		if(size() != that.size()) return false;
+		return detail::equal_n(data(), that.data(), size());
+	}
+		
+	//three-way comparison operator, to generate all the other comparison operators for us!
+	// ... but does require that T is itself three-way comparable. Might be too much to ask.
+	// ... so we only offer it when it is.
+	// (for integers and bytes it skips the equal prefix with memcmp, see detail::)
+	auto operator<=>(const Vec& that) const noexcept requires std::three_way_comparable<T>{
+		return detail::compare_three_way_n(data(), size(), that.data(), that.size());
+	}
+
+	//the expected container interface, as per cppreference on std::vector:	
+	auto data() noexcept		-> pointer			{ return assume_aligned(_data); }
+	auto data() const noexcept	-> const_pointer	{ return assume_aligned(_data); }
+
+	auto begin() noexcept		-> iterator			{ return iterator_at(data()); };
+	auto begin() const noexcept -> const_iterator	{ return iterator_at(data()); };
+	
+	auto end() noexcept			-> iterator			{ return iterator_at(data() + size()); }
+	auto end() const noexcept	-> const_iterator	{ return iterator_at(data() + size()); }
+	
+	auto size() const noexcept	-> size_type		{ return _size; }	
+	auto empty() const noexcept -> bool				{ return size() == 0; }
+	auto capacity() const noexcept -> size_type		{ return _capacity; }
+	auto max_size() const noexcept -> size_type{
+		return std::min<size_type>(alloc_traits::max_size(_alloc),
+			std::numeric_limits<size_type>::max() / sizeof(value_type));
+	}
+	auto get_allocator() const noexcept -> allocator_type { return _alloc; }
+	
+	auto clear() noexcept		-> void				{ release(); } 
+	// noexcept is correct here.
+	// clear() destroys the elements and frees the buffer, leaving us as if
+	// default-constructed, but keeping our allocator. None of that can throw.
+		
+	auto operator[](size_type index) noexcept -> reference {
+		assert(index < size() && "Vec<T>: Index out of bounds in operator[]");
+		return _data[index];
+	}	
+	auto operator[](size_type index) const noexcept -> const_reference{
+		assert(index < size() && "Vec<T>: Index out of bounds in operator[]");
+		return _data[index];
+	}
+
+	auto front() noexcept -> reference{
+		assert(!empty() && "Calling front() on an empty vec is undefined behavior!");
+		return (*this)[0]; //use operator[] for all index accesses.
+	}
+	auto front() const noexcept -> const_reference{
+		assert(!empty() && "Calling front() on an empty vec is undefined behavior!");
+		return (*this)[0];
+	}
+
+	auto back() noexcept -> reference{
+		assert(!empty() && "Calling back() on an empty vec is undefined behavior!");
+		return (*this)[size() - 1];
+	}
+	auto back() const noexcept -> const_reference{
+		assert(!empty() && "Calling back() on an empty vec is undefined behavior!");
+		return (*this)[size() - 1];
+	}	
+
+	auto at(size_type index) -> reference{
+		if(index < size()){
+			return (*this)[index];
+		}
+		throw std::out_of_range("Vec<T>: Index out of bounds in at()");
+	}
+	auto at(size_type index) const -> const_reference{
+		if(index < size()){
+			return (*this)[index];
+		}
+		throw std::out_of_range("Vec<T>: Index out of bounds in at()");
+	}
+
+	// make room for at least 'new_cap' elements without changing size().
+	// Strong guarantee: if anything throws, *this is left untouched.
+	auto reserve(size_type new_cap) -> void requires std::move_constructible<T>{
+		if(new_cap <= capacity()){
+			return;
+		}
+		if(new_cap > max_size()){
+			throw std::length_error("Vec<T>: reserve() exceeds max_size()");
+		}
+		reallocate(new_cap);
+	}
+
+	// non-binding request to drop unused capacity. Vec honors it.
+	auto shrink_to_fit() -> void requires std::move_constructible<T>{
+		if(capacity() > size()){
+			reallocate(size());
+		}
+	}
+
+	auto push_back(const value_type& val) -> void requires std::copy_constructible<T>{
+		emplace_back(val);
+	}
+	auto push_back(value_type&& val) -> void{ emplace_back(std::move(val)); }
+
+	// the new element is built *before* we touch the old buffer, so
+	// v.push_back(v[0]) is safe even when it triggers a reallocation.
+	template<typename... Args>
+		requires std::constructible_from<T, Args...> && std::move_constructible<T>
+	auto emplace_back(Args&&... args) -> reference{
+		if(size() < capacity()){
+			alloc_traits::construct(_alloc, _data + _size, std::forward<Args>(args)...);
+			++_size;
+		} else if(!realloc_relocate || !_data){
+			insert_into_fresh(size(), 1, next_capacity(), [&](pointer p){
+				alloc_traits::construct(_alloc, p, std::forward<Args>(args)...);
+			});
+		} else{
+			// the allocator may free the old buffer under us, so build a temporary first.
+			T value(std::forward<Args>(args)...);
+			if(try_realloc(next_capacity())){
+				alloc_traits::construct(_alloc, _data + _size, std::move(value));
+				++_size;
+			} else{
+				insert_into_fresh(size(), 1, next_capacity(), [&](pointer p){
+					alloc_traits::construct(_alloc, p, std::move(value));
+				});
+			}
+		}
+		return back();
+	}
+
+	// removes the last element. Nothing moves, so iterators to the others stay valid.
+	auto pop_back() noexcept -> void{
+		assert(!empty() && "Vec<T>: pop_back() on an empty Vec");
+		truncate(size() - 1);
+	}
+
+	// inserting and erasing in the middle shift the tail once, however many elements go
+	// in or out. Trivially relocatable elements (see is_trivially_relocatable) shift with
+	// one memmove, others are moved one by one. Either way, every iterator into the Vec
+	// is invalidated, not just those past 'pos'.
+	// The inserted elements may be copies of our own, v.insert(v.begin(), v.back()) works.
+	// Ranges may not: [first, last) must not point into the Vec, same as for std::vector.
+	// If inserting has to reallocate, it has the strong guarantee, like push_back.
+
+	// inserts T(args...) before 'pos', returns an iterator to it.
+	template<typename... Args>
+		requires std::constructible_from<T, Args...> && shiftable
+	auto emplace(const_iterator pos, Args&&... args) -> iterator{
+		const size_type index = index_of(pos);
+		if constexpr(memcpy_relocate){
+			// args may refer to an element we are about to shift, so build the new one first.
+			T value(std::forward<Args>(args)...);
+			insert_with(index, 1, [&](pointer p){
+				alloc_traits::construct(_alloc, p, std::move(value));
+			});
+		} else{
+			insert_with(index, 1, [&](pointer p){
+				alloc_traits::construct(_alloc, p, std::forward<Args>(args)...);
+			});
+		}
+		return iterator_at(data() + index);
+	}
+	auto insert(const_iterator pos, const value_type& val) -> iterator
+		requires std::copy_constructible<T> && shiftable{
+		return emplace(pos, val);
+	}
+	auto insert(const_iterator pos, value_type&& val) -> iterator requires shiftable{
+		return emplace(pos, std::move(val));
+	}
+
+	// inserts 'count' copies of 'val' before 'pos', returns an iterator to the first one.
+	auto insert(const_iterator pos, size_type count, const value_type& val) -> iterator
+		requires std::copy_constructible<T> && shiftable{
+		const size_type index = index_of(pos);
+		if constexpr(memcpy_relocate){
+			const T copy(val); // 'val' may be one of ours, about to be shifted
+			insert_with(index, count, [&](pointer dest){ fill_construct_n(dest, count, copy); });
+		} else{
+			insert_with(index, count, [&](pointer dest){ fill_construct_n(dest, count, val); });
+		}
+		return iterator_at(data() + index);
+	}
+
+	// inserts copies of [first, last) before 'pos', returns an iterator to the first one.
+	template<std::forward_iterator It>
+		requires std::constructible_from<T, std::iter_reference_t<It>> && shiftable
+	auto insert(const_iterator pos, It first, It last) -> iterator{
+		const size_type index = index_of(pos);
+		const auto count = static_cast<size_type>(std::ranges::distance(first, last));
+		insert_with(index, count, [&](pointer dest){ copy_construct_n(first, count, dest); });
+		return iterator_at(data() + index);
+	}
+	auto insert(const_iterator pos, std::initializer_list<value_type> l) -> iterator
+		requires std::copy_constructible<T> && shiftable{
+		return insert(pos, l.begin(), l.end());
+	}
+
+	// the same for any range.
+	template<std::ranges::input_range R>
+		requires std::constructible_from<T, std::ranges::range_reference_t<R>> && shiftable
+	auto insert_range(const_iterator pos, R&& range) -> iterator{
+		const size_type index = index_of(pos);
+		if constexpr(std::ranges::forward_range<R> || std::ranges::sized_range<R>){
+			const auto count = static_cast<size_type>(std::ranges::distance(range));
+			insert_with(index, count, [&](pointer dest){
+				copy_construct_n(std::ranges::begin(range), count, dest);
+			});
+		} else{
+			// this one can't tell its size up front, so gather it first.
+			Vec gathered(_alloc);
+			gathered.append_range(std::forward<R>(range));
+			const size_type count = gathered.size();
+			insert_with(index, count, [&](pointer dest){
+				copy_construct_n(std::make_move_iterator(gathered._data), count, dest);
+			});
+		}
+		return iterator_at(data() + index);
+	}
+
+	// appends copies of the range's elements, growing (at most) once if it knows its size.
+	template<std::ranges::input_range R>
+		requires std::constructible_from<T, std::ranges::range_reference_t<R>>
+			&& std::move_constructible<T>
+	auto append_range(R&& range) -> void{
+		if constexpr(std::ranges::forward_range<R> || std::ranges::sized_range<R>){
+			const auto count = static_cast<size_type>(std::ranges::distance(range));
+			append_with(count, [&](pointer dest){
+				copy_construct_n(std::ranges::begin(range), count, dest);
+			});
+		} else{
+			for(auto&& element : range){
+				emplace_back(std::forward<decltype(element)>(element));
+			}
+		}
+	}
+
+	// erases the element at 'pos' (or [first, last)), returns an iterator to the element
+	// that followed it. The tail is shifted down once.
+	auto erase(const_iterator pos) -> iterator requires shiftable{
+		assert(index_of(pos) < size() && "Vec<T>: erase(end()) is undefined behavior!");
+		return erase(pos, std::next(pos));
+	}
+	auto erase(const_iterator first, const_iterator last) -> iterator requires shiftable{
+		const size_type index = index_of(first);
+		assert(index <= index_of(last) && "Vec<T>: erase(first, last) with first after last");
+		const size_type count = index_of(last) - index;
+		if(count != 0){
+			const pointer gap = _data + index;
+			const size_type tail = size() - index - count;
+			if constexpr(memcpy_relocate){
+				destroy_n(gap, count);
+				move_bytes(gap, gap + count, tail);
+			} else{
+				std::move(gap + count, _data + _size, gap);
+				destroy_n(gap + tail, count);
+			}
+			_size -= count;
+			invalidate_iterators();
+		}
+		return iterator_at(data() + index);
+	}
+
+	// removes every element 'pred' is true for, in a single pass, keeping the others in
+	// order. Returns how many it removed. Same as std::erase_if for std::vector.
+	template<typename Pred> requires std::predicate<Pred&, const T&> && shiftable
+	friend auto erase_if(Vec& v, Pred pred) -> size_type{
+		return v.remove_where(pred);
+	}
+	template<typename U = T> requires shiftable
+	friend auto erase(Vec& v, const U& value) -> size_type{
+		auto equal = [&](const T& element){ return element == value; };
+		return v.remove_where(equal);
+	}
+
+	// grows with value-initialized elements (or copies of 'val'), or destroys the excess.
+	auto resize(size_type count) -> void
+		requires std::default_initializable<T> && std::move_constructible<T>{
+		if(count <= size()){
+			truncate(count);
+		} else{
+			const size_type more = count - size();
+			append_with(more, [&](pointer dest){ value_construct_n(dest, more); });
+		}
+	}
+	auto resize(size_type count, const value_type& val) -> void requires std::copy_constructible<T>{
+		if(count <= size()){
+			truncate(count);
+		} else if(const size_type more = count - size(); realloc_relocate && more > spare()){
+			const T copy(val); // 'val' may be one of ours, and realloc may free it
+			append_with(more, [&](pointer dest){ fill_construct_n(dest, more, copy); });
+		} else{
+			append_with(more, [&](pointer dest){ fill_construct_n(dest, more, val); });
+		}
+	}
+
+	// resizes to 'count' without initializing the new elements, then lets op(data(), count)
+	// write them, like std::string::resize_and_overwrite. op returns how many elements
+	// are valid (at most 'count'), and the Vec is cut down to that. So a C API or syscall
+	// fills the Vec directly, with no zeroing pass first:
+	//	const size_t had = buffer.size();
+	//	buffer.resize_and_overwrite(had + 4096, [&](std::byte* p, size_t n){
+	//		return had + std::fread(p + had, 1, n - had, file);
+	//	});
+	// The first min(size(), count) elements keep their values, the others are garbage
+	// until op writes them: only for types that can live in uninitialized memory. Growing
+	// is geometric, so calls like the one above append in amortized O(1). (An allocator
+	// with its own construct() still gets to construct the new elements first.)
+	// If op throws, the Vec keeps its old elements (those op wrote to are overwritten).
+	template<typename Op>
+		requires std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>
+			&& requires(Op op, pointer p, size_type n){ { std::move(op)(p, n) } -> std::integral; }
+	auto resize_and_overwrite(size_type count, Op op) -> void{
+		const size_type old_size = size();
+		if(count > capacity()){
+			reallocate(capacity_for(count - old_size));
+		}
+		if constexpr(!plain_construct){
+			if(count > old_size){
+				value_construct_n(_data + old_size, count - old_size);
+			}
+		}
+		size_type written = 0;
+		try{
+			// (the unary + promotes a bool or character result to int, or a wider integer:
+			// std::cmp_* only take the standard integer types.)
+			const auto result = +std::move(op)(data(), count);
+			assert(std::cmp_greater_equal(result, 0) && std::cmp_less_equal(result, count)
+				&& "Vec<T>: resize_and_overwrite() op returned more than 'count'");
+			written = static_cast<size_type>(result);
+		} catch(...){
+			if(count > old_size){
+				destroy_n(_data + old_size, count - old_size);
+			}
+			throw;
+		}
+		_size = std::max(old_size, count);
+		truncate(written);
+	}
+
+	// replaces the contents. When they fit in our buffer, the elements we have are
+	// assigned to and the buffer is reused. If not, the new contents are built in a fresh
+	// buffer, and *this is untouched if that throws.
+	auto assign(size_type count, const value_type& val) -> void requires std::copyable<T>{
+		if(count > capacity()){
+			Vec temp(reserve_only, count, _alloc);
+			temp.fill_construct_n(temp._data, count, val);
+			temp._size = count;
+			swap_storage(temp);
+			return;
+		}
+		// assigning first, constructing after, so 'val' may be one of ours.
+		if(count > size()){
+			std::fill_n(_data, size(), val);
+			fill_construct_n(_data + _size, count - size(), val);
+			_size = count;
+		} else{
+			std::fill_n(_data, count, val);
+			truncate(count);
+		}
+		invalidate_iterators();
+	}
+	template<std::forward_iterator It>
+		requires std::constructible_from<T, std::iter_reference_t<It>>
+			&& std::assignable_from<T&, std::iter_reference_t<It>>
+	auto assign(It first, It last) -> void{
+		const auto count = static_cast<size_type>(std::ranges::distance(first, last));
+		if(count > capacity()){
+			Vec temp(reserve_only, count, _alloc);
+			temp.copy_construct_n(first, count, temp._data);
+			temp._size = count;
+			swap_storage(temp);
+			return;
+		}
+		// std::copy_n is a memmove for trivially copyable T.
+		if(count > size()){
+			first = std::ranges::copy_n(first, static_cast<std::iter_difference_t<It>>(size()),
+				_data).in;
+			copy_construct_n(first, count - size(), _data + _size);
+			_size = count;
+		} else{
+			std::copy_n(first, count, _data);
+			truncate(count);
+		}
+		invalidate_iterators();
+	}
+	auto assign(std::initializer_list<value_type> l) -> void requires std::copyable<T>{
+		assign(l.begin(), l.end());
+	}
+	template<std::ranges::input_range R>
+		requires std::constructible_from<T, std::ranges::range_reference_t<R>>
+			&& std::assignable_from<T&, std::ranges::range_reference_t<R>>
+			&& std::move_constructible<T>
+	auto assign_range(R&& range) -> void{
+		if constexpr(std::ranges::forward_range<R>){
+			if constexpr(std::ranges::common_range<R>){
+				assign(std::ranges::begin(range), std::ranges::end(range));
+			} else{
+				auto first = std::ranges::begin(range);
+				assign(first, std::ranges::next(first, std::ranges::end(range)));
+			}
+		} else{
+			truncate(0);
+			invalidate_iterators();
+			append_range(std::forward<R>(range));
+		}
+	}
+
+	// the allocators are only swapped if they propagate on swap. If they don't,
+	// they had better be equal, or neither Vec could free its new buffer.
+	auto swap(Vec& that) noexcept -> void{
+		if constexpr(alloc_traits::propagate_on_container_swap::value){
+			using std::swap; //std::swap two-step, to let us use ADL.
+			swap(_alloc, that._alloc);
+		} else{
+			assert(_alloc == that._alloc && "Vec<T>: swapping Vecs with unequal allocators");
+		}
+		swap_storage(that);
+	}
+	//two-argument swap function as friend
+	friend auto swap(Vec& a, Vec& b) noexcept -> void{
+		a.swap(b); //delegate to the member version
+	}
+
+private:	
+	friend struct detail::vec_parallel;
+
+	struct reserve_only_t{};
+	static constexpr reserve_only_t reserve_only{};
+
+	// allocates room for 'count' elements, but constructs none of them.
+	Vec(reserve_only_t, size_type count, const Alloc& alloc)
+		: _alloc(alloc)
+		, _data(allocate(count))
+		, _capacity(count){}
+
+	// raw, uninitialized storage. Nothing lives here until we construct it.
+	auto allocate(size_type count) -> pointer{
+		if(count > max_size()){
+			throw std::length_error("Vec<T>: allocation exceeds max_size()");
+		}
+		return count ? alloc_traits::allocate(_alloc, count) : nullptr;
+	}
+	auto deallocate(pointer p, size_type count) noexcept -> void{
+		if(p){
+			alloc_traits::deallocate(_alloc, p, count);
+		}
+	}
+
+	auto destroy_n(pointer first, size_type count) noexcept -> void{
+		if constexpr(plain_construct){
+			std::destroy_n(first, count);
+		} else{
+			for(size_type i = 0; i < count; ++i){
+				alloc_traits::destroy(_alloc, first + i);
+			}
+		}
+	}
+
+	// 'count' value-initialized elements (or copies of 'val') at uninitialized 'dest'.
+	auto value_construct_n(pointer dest, size_type count) -> void{
+		if constexpr(plain_construct){
+			std::uninitialized_value_construct_n(dest, count);
+		} else{
+			construct_n(dest, count, [&](pointer p, size_type){
+				alloc_traits::construct(_alloc, p);
+			});
+		}
+	}
+	auto fill_construct_n(pointer dest, size_type count, const value_type& val) -> void{
+		if constexpr(plain_construct){
+			std::uninitialized_fill_n(dest, count, val);
+		} else{
+			construct_n(dest, count, [&](pointer p, size_type){
+				alloc_traits::construct(_alloc, p, val);
+			});
+		}
+	}
+
+	// destroys the elements from 'count' on. Nothing moves, so iterators stay valid.
+	auto truncate(size_type count) noexcept -> void{
+		destroy_n(_data + count, _size - count);
+		_size = count;
+	}
+
+	// constructs 'count' elements at 'dest' through the allocator, calling make(p, i)
+	// for the i'th element. If one of them throws, the ones already built are destroyed.
+	template<typename Make>
+	auto construct_n(pointer dest, size_type count, Make make) -> void{
+		size_type built = 0;
+		try{
+			for(; built < count; ++built){
+				make(dest + built, built);
+			}
+		} catch(...){
+			destroy_n(dest, built);
+			throw;
+		}
+	}
+
+	// copy-constructs [first, last) into uninitialized 'dest'.
+	// Trivially copyable elements in contiguous memory are just bytes, so one memcpy does it.
+	template<std::forward_iterator It>
+	auto copy_construct(It first, It last, pointer dest) -> void{
+		if constexpr(memcpy_construct && std::contiguous_iterator<It>
+			&& std::is_same_v<std::iter_value_t<It>, value_type>){
+			const auto count = static_cast<size_type>(last - first);
+			if(count){
+				std::memcpy(dest, std::to_address(first), count * sizeof(value_type));
+			}
+		} else if constexpr(plain_construct){
+			std::uninitialized_copy(first, last, dest);
+		} else{
+			construct_n(dest, static_cast<size_type>(std::ranges::distance(first, last)),
+				[&](pointer p, size_type){
+					alloc_traits::construct(_alloc, p, *first);
+					++first;
+				});
+		}
+	}
+
+	// the same, for 'count' elements starting at 'first'.
+	template<std::input_iterator It>
+	auto copy_construct_n(It first, size_type count, pointer dest) -> void{
+		if constexpr(memcpy_construct && std::contiguous_iterator<It>
+			&& std::is_same_v<std::iter_value_t<It>, value_type>){
+			if(count){
+				std::memcpy(dest, std::to_address(first), count * sizeof(value_type));
+			}
+		} else if constexpr(plain_construct){
+			std::uninitialized_copy_n(first, count, dest);
+		} else{
+			construct_n(dest, count, [&](pointer p, size_type){
+				alloc_traits::construct(_alloc, p, *first);
+				++first;
+			});
+		}
+	}
+
+	// move-constructs 'count' elements from 'src' into uninitialized 'dest'.
+	auto move_construct(pointer src, size_type count, pointer dest) -> void{
+		if constexpr(memcpy_construct){
+			copy_construct(src, src + count, dest);
+		} else{
+			construct_n(dest, count, [&](pointer p, size_type i){
+				alloc_traits::construct(_alloc, p, std::move(src[i]));
+			});
+		}
+	}
+
+	// move-constructs (or copies, if moving could throw) 'count' of our elements from 'src'
+	// into the uninitialized 'dest'. Copying keeps the strong guarantee intact for types
+	// with throwing moves: that is what std::move_if_noexcept is for.
+	// Trivially relocatable elements are just copied as bytes, which can't throw.
+	auto relocate_n(pointer src, size_type count, pointer dest) -> void{
+		if constexpr(memcpy_relocate){
+			move_bytes(dest, src, count);
+		} else{
+			construct_n(dest, count, [&](pointer p, size_type i){
+				alloc_traits::construct(_alloc, p, std::move_if_noexcept(src[i]));
+			});
+		}
+	}
+
+	// relocates 'count' trivially relocatable elements as bytes. The ranges may overlap.
+	static auto move_bytes(pointer dest, const_pointer src, size_type count) noexcept -> void{
+		if(count){
+			std::memmove(static_cast<void*>(dest), src, count * sizeof(value_type));
+		}
+	}
+
+	// destroys our elements and frees the old buffer, then takes ownership of 'fresh',
+	// which must already hold size() relocated elements. (Bitwise relocated elements
+	// live on in 'fresh', so the old ones must not be destroyed.)
+	auto adopt(pointer fresh, size_type new_cap) noexcept -> void{
+		if constexpr(!memcpy_relocate){
+			destroy_n(_data, _size);
+		}
+		deallocate(_data, _capacity);
+		invalidate_iterators();
+		_data = fresh;
+		_capacity = new_cap;
+	}
+
+	auto reallocate(size_type new_cap) -> void{
+		if(try_realloc(new_cap)){
+			return;
+		}
+		pointer fresh = allocate(new_cap);
+		try{
+			relocate_n(_data, _size, fresh);
+		} catch(...){
+			deallocate(fresh, new_cap);
+			throw;
+		}
+		adopt(fresh, new_cap);
+	}
+
+	// makes room for 'count' elements at 'index' and has fill(dest) construct them there.
+	// fill must construct exactly 'count' elements, or none if it throws.
+	template<typename Fill>
+	auto insert_with(size_type index, size_type count, Fill fill) -> void{
+		if(count == 0){
+			return;
+		}
+		if(count > spare()){
+			const size_type new_cap = capacity_for(count);
+			if(!try_realloc(new_cap)){
+				insert_into_fresh(index, count, new_cap, fill);
+				return;
+			}
+		}
+		const pointer gap = _data + index;
+		const size_type tail = size() - index;
+		if constexpr(memcpy_relocate){
+			// shift the tail out of the way, and back again if fill throws.
+			move_bytes(gap + count, gap, tail);
+			try{
+				fill(gap);
+			} catch(...){
+				move_bytes(gap, gap + count, tail);
+				throw;
+			}
+			_size += count;
+		} else{
+			// build the new ones past the end, before anything moves (they may be copies of
+			// our own), then rotate them into place.
+			fill(_data + _size);
+			_size += count;
+			std::rotate(gap, gap + tail, _data + _size);
+		}
+		invalidate_iterators();
+	}
+
+	// insert_with at the end: no shifting, just growing if need be.
+	template<typename Fill>
+	auto append_with(size_type count, Fill fill) -> void{
+		if(count > spare()){
+			const size_type new_cap = capacity_for(count);
+			if(!try_realloc(new_cap)){
+				insert_into_fresh(size(), count, new_cap, fill);
+				return;
+			}
+		}
+		fill(_data + _size);
+		_size += count;
+	}
+
+	// out of room: a fresh buffer, the new elements first, then the old ones around them.
+	// The old buffer is left alone until the end, so if anything throws, *this is untouched,
+	// and fill can still read from it.
+	template<typename Fill>
+	auto insert_into_fresh(size_type index, size_type count, size_type new_cap, Fill fill)
+		-> void{
+		pointer fresh = allocate(new_cap);
+		try{
+			fill(fresh + index);
+		} catch(...){
+			deallocate(fresh, new_cap);
+			throw;
+		}
+		try{
+			relocate_n(_data, index, fresh);
+		} catch(...){
+			destroy_n(fresh + index, count);
+			deallocate(fresh, new_cap);
+			throw;
+		}
+		try{
+			relocate_n(_data + index, size() - index, fresh + index + count);
+		} catch(...){
+			destroy_n(fresh, index + count);
+			deallocate(fresh, new_cap);
+			throw;
+		}
+		adopt(fresh, new_cap);
+		_size += count;
+	}
+
+	// the single pass behind erase_if: survivors move down over the gaps, right away.
+	template<typename Pred>
+	auto remove_where(Pred& pred) -> size_type{
+		const size_type old_size = size();
+		// trivially copyable elements are best left to std::remove_if. Others, that are
+		// trivially relocatable, we move as bytes, saving a move-assignment and a destructor.
+		if constexpr(memcpy_relocate && !std::is_trivially_copyable_v<T>){
+			size_type kept = 0;
+			size_type i = 0;
+			try{
+				for(; i < old_size; ++i){
+					if(pred(std::as_const(_data[i]))){
+						destroy_n(_data + i, 1);
+					} else{
+						if(kept != i){
+							move_bytes(_data + kept, _data + i, 1);
+						}
+						++kept;
+					}
+				}
+			} catch(...){
+				// close the gap left so far, then let it go.
+				move_bytes(_data + kept, _data + i, old_size - i);
+				_size = kept + (old_size - i);
+				invalidate_iterators();
+				throw;
+			}
+			_size = kept;
+		} else{
+			const pointer last = std::remove_if(_data, _data + _size,
+				[&](const T& element){ return pred(element); });
+			truncate(static_cast<size_type>(last - _data));
+		}
+		if(size() != old_size){
+			invalidate_iterators();
+		}
+		return old_size - size();
+	}
+
+	// hands the resizing to the allocator, if it can do that (see realloc_relocate). Growing
+	// with realloc or mremap usually extends the buffer where it is, or moves its pages
+	// without copying them. True if it worked; if not, *this is untouched.
+	auto try_realloc(size_type new_cap) -> bool{
+		if constexpr(realloc_relocate){
+			if(_data && new_cap != 0){
+				if(pointer moved = _alloc.reallocate(_data, _capacity, new_cap)){
+					invalidate_iterators();
+					_data = moved;
+					_capacity = new_cap;
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	// destroys everything and frees the buffer, leaving an empty Vec.
+	auto release() noexcept -> void{
+		destroy_n(_data, _size);
+		deallocate(_data, _capacity);
+		_data = nullptr;
+		_size = 0;
+		_capacity = 0;
+		invalidate_iterators();
+	}
+
+	// the buffer changes hands, the allocators stay put. Only valid when
+	// the allocators are equal (or we know they are about to be).
+	auto swap_storage(Vec& that) noexcept -> void{
+		using std::swap;
+		swap(_data, that._data);
+		swap(_size, that._size);
+		swap(_capacity, that._capacity);
+		invalidate_iterators();
+		that.invalidate_iterators();
+	}
+	auto steal_storage(Vec& that) noexcept -> void{
+		_data = std::exchange(that._data, nullptr);
+		_size = std::exchange(that._size, 0);
+		_capacity = std::exchange(that._capacity, 0);
+		invalidate_iterators();
+		that.invalidate_iterators();
+	}
+
+#if VEC_CHECKED_ITERATORS
+	template<typename, typename>
+	friend class detail::checked_iterator;
+
+	auto iterator_at(pointer p) noexcept -> iterator{ return iterator(this, p); }
+	auto iterator_at(const_pointer p) const noexcept -> const_iterator{
+		return const_iterator(this, p);
+	}
+	// every iterator handed out before this call is now stale.
+	auto invalidate_iterators() noexcept -> void{ ++_generation; }
+#else
+	static auto iterator_at(pointer p) noexcept -> iterator{ return p; }
+	static auto iterator_at(const_pointer p) noexcept -> const_iterator{ return p; }
+	static auto invalidate_iterators() noexcept -> void{}
+#endif
+
+	// std::assume_aligned wants a pointer to an object, so an empty Vec's nullptr stays out.
+	template<typename P>
+	static auto assume_aligned(P* p) noexcept -> P*{
+		if constexpr(alignment > alignof(T)){
+			return p ? std::assume_aligned<alignment>(p) : p;
+		} else{
+			return p;
+		}
+	}
+
+	auto spare() const noexcept -> size_type{ return capacity() - size(); }
+
+	// capacity for 'count' more elements: the next geometric step, or more if that's not enough.
+	auto capacity_for(size_type count) const -> size_type{
+		if(count > max_size() - size()){
+			throw std::length_error("Vec<T>: cannot grow beyond max_size()");
+		}
+		return std::max(next_capacity(), size() + count);
+	}
+
+	// where 'pos' points, as an index. end() is fine too.
+	auto index_of(const_iterator pos) const noexcept -> size_type{
+		const auto index = pos - begin();
+		assert(index >= 0 && static_cast<size_type>(index) <= size()
+			&& "Vec<T>: iterator out of range");
+		return static_cast<size_type>(index);
+	}
+
+	// capacity after the next geometric step. Always makes room for at least one more.
+	auto next_capacity() const -> size_type{
+		if(capacity() == max_size()){
+			throw std::length_error("Vec<T>: cannot grow beyond max_size()");
+		}
+		// capacity * num / den, split up so that capacity * num can't overflow on the way:
+		// (capacity / den) * num, plus what the remainder adds (less than num).
+		constexpr size_type num = GrowthFactor::num;
+		constexpr size_type den = GrowthFactor::den;
+		const size_type extra = capacity() % den * num / den;
+		const size_type whole = capacity() / den;
+		const size_type grown = whole <= (max_size() - extra) / num
+			? whole * num + extra
+			: max_size();
+		return std::max(grown, capacity() + 1);
+	}
+
+	VEC_NO_UNIQUE_ADDRESS Alloc _alloc = Alloc();
+	pointer _data = nullptr;
+	size_t _size = 0;
+	size_t _capacity = 0;
+#if VEC_CHECKED_ITERATORS
+	size_t _generation = 0;
+#endif
+};
+
+// Vec(from_range, range) is a Vec of the range's value type.
+template<std::ranges::input_range R, typename Alloc = std::allocator<std::ranges::range_value_t<R>>>
+Vec(from_range_t, R&&, Alloc = Alloc()) -> Vec<std::ranges::range_value_t<R>, Alloc>;
+
+// Vec with a polymorphic allocator, mirroring std::pmr::vector. Hand it a
+// std::pmr::monotonic_buffer_resource and all its memory comes out of that arena.
+namespace pmr{
+template<typename T, typename GrowthFactor = std::ratio<2>>
+using Vec = ::Vec<T, std::pmr::polymorphic_allocator<T>, GrowthFactor>;
+}
+
+#pragma warning(pop)
@@ -0,0 +1,207 @@
+#pragma once
+#include <algorithm>      // std::min
+#include <bit>            // std::endian
+#include <cerrno>
+#include <concepts>       // std::default_initializable
+#include <cstddef>        // std::byte
+#include <cstdint>
+#include <cstring>        // std::memcpy
+#include <memory>         // std::allocator, std::allocator_traits
+#include <ratio>          // std::ratio, Vec's default growth factor
+#include <span>
+#include <stdexcept>      // std::runtime_error
+#include <system_error>   // std::system_error, for failing OS calls
+#include <type_traits>    // std::is_trivially_copyable_v
+#include "Vec.h"
+
+#if defined(_WIN32)
+#include <io.h>           // _read, _write
+#else
+#include <sys/uio.h>      // writev
+#include <unistd.h>       // read, write
+#endif
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // bounds.1 - pointer arithmetic, we manage raw buffers ourselves
+#pragma warning(disable : 26490) // type.1 - reinterpret_cast, bytes in the buffer become T's
+
+// A binary file format for Vecs of trivially copyable T: a 64-byte header, then the
+// elements exactly as they are laid out in memory. No per-element work in either direction:
+//	write_to(fd, v)			one writev() of header + data()
+//	read_from<T>(fd)		one read() straight into the data() of an uninitialized Vec
+//	view_from<T>(bytes)		no read at all: a span over an already loaded (or mmap'd) buffer
+// The header records everything that has to match for those bytes to mean the same thing
+// to the reader: element size and alignment, and byte order. We refuse to load anything
+// else, rather than hand out garbage.
+
+struct VecFileHeader{
+	static constexpr char expected_magic[8] = {'R', 'A', 'I', 'I', 'V', 'E', 'C', '\0'};
+	static constexpr std::uint32_t current_version = 1;
+	static constexpr std::uint32_t native_byte_order = 0x01020304; // reads 0x04030201 if swapped
+
+	char magic[8] = {};
+	std::uint32_t version = 0;
+	std::uint32_t byte_order = 0;
+	std::uint32_t element_size = 0;
+	std::uint32_t element_alignment = 0;
+	std::uint64_t count = 0;
+	std::uint64_t data_offset = 0; // from the start of the header. Always 64, in version 1.
+	std::byte reserved[24] = {};
+
+	template<typename T>
+	static auto describe(size_t count) noexcept -> VecFileHeader{
+		VecFileHeader header;
+		std::memcpy(header.magic, expected_magic, sizeof(magic));
+		header.version = current_version;
+		header.byte_order = native_byte_order;
+		header.element_size = sizeof(T);
+		header.element_alignment = alignof(T);
+		header.count = count;
+		header.data_offset = sizeof(VecFileHeader);
+		return header;
+	}
+
+	// throws unless this header describes an array of T's that we can use as-is.
+	template<typename T>
+	auto validate() const -> void{
+		if(std::memcmp(magic, expected_magic, sizeof(magic)) != 0){
+			throw std::runtime_error("VecIO: not a Vec file");
+		}
+		if(version != current_version){
+			throw std::runtime_error("VecIO: unsupported file version");
+		}
+		if(byte_order != native_byte_order){
+			throw std::runtime_error("VecIO: file was written with a different byte order");
+		}
+		if(element_size != sizeof(T) || element_alignment != alignof(T)){
+			throw std::runtime_error("VecIO: file holds a different element type");
+		}
+		if(data_offset != sizeof(VecFileHeader)){
+			throw std::runtime_error("VecIO: unexpected data offset");
+		}
+	}
+};
+static_assert(sizeof(VecFileHeader) == 64 && std::is_trivially_copyable_v<VecFileHeader>);
+static_assert(std::endian::native == std::endian::little || std::endian::native == std::endian::big,
+	"VecIO: mixed-endian platforms are not supported");
+
+namespace detail{
+[[noreturn]] inline auto throw_io_error(const char* what) -> void{
+	throw std::system_error(errno, std::generic_category(), what);
+}
+
+// read() may return less than we asked for. Keep going until we have it all.
+inline auto read_fully(int fd, void* buffer, size_t bytes) -> void{
+	auto* out = static_cast<std::byte*>(buffer);
+	while(bytes > 0){
+#if defined(_WIN32)
+		const auto chunk = static_cast<unsigned>(std::min<size_t>(bytes, 1u << 30));
+		const auto got = ::_read(fd, out, chunk);
+#else
+		const auto got = ::read(fd, out, bytes);
+#endif
+		if(got < 0){
+			if(errno == EINTR) continue;
+			throw_io_error("VecIO: read failed");
+		}
+		if(got == 0){
+			throw std::runtime_error("VecIO: unexpected end of file");
+		}
+		out += got;
+		bytes -= static_cast<size_t>(got);
+	}
+}
+
+// writes 'first' and then 'second'. On POSIX that is a single writev() in the common case.
+inline auto write_fully(int fd, std::span<const std::byte> first, std::span<const std::byte> second)
+	-> void{
+#if defined(_WIN32)
+	for(auto bytes : {first, second}){
+		while(!bytes.empty()){
+			const auto chunk = static_cast<unsigned>(std::min<size_t>(bytes.size(), 1u << 30));
+			const auto put = ::_write(fd, bytes.data(), chunk);
+			if(put < 0){
+				throw_io_error("VecIO: write failed");
+			}
+			bytes = bytes.subspan(static_cast<size_t>(put));
+		}
+	}
+#else
+	iovec parts[2] = {
+		{const_cast<std::byte*>(first.data()), first.size()},
+		{const_cast<std::byte*>(second.data()), second.size()}
+	};
+	iovec* part = parts;
+	int parts_left = second.empty() ? 1 : 2;
+	while(parts_left > 0){
+		const auto put = ::writev(fd, part, parts_left);
+		if(put < 0){
+			if(errno == EINTR) continue;
+			throw_io_error("VecIO: write failed");
+		}
+		// skip what was written, which may end in the middle of a part
+		auto done = static_cast<size_t>(put);
+		while(parts_left > 0 && done >= part->iov_len){
+			done -= part->iov_len;
+			++part;
+			--parts_left;
+		}
+		if(parts_left > 0){
+			part->iov_base = static_cast<std::byte*>(part->iov_base) + done;
+			part->iov_len -= done;
+		}
+	}
+#endif
+}
+}
+
+// writes 'v' to the file descriptor 'fd', at its current position.
+template<typename T, typename Alloc, typename GrowthFactor>
+	requires std::is_trivially_copyable_v<T>
+auto write_to(int fd, const Vec<T, Alloc, GrowthFactor>& v) -> void{
+	const auto header = VecFileHeader::describe<T>(v.size());
+	detail::write_fully(fd, std::as_bytes(std::span(&header, 1)),
+		std::as_bytes(std::span(v.data(), v.size())));
+}
+
+// reads a Vec<T> from the file descriptor 'fd', at its current position. The elements are
+// read straight into default-initialized (that is: untouched) storage, no zeroing first.
+// Any Vec that write_to() takes comes back: read_from<T, Alloc, GrowthFactor>(fd).
+template<typename T, typename Alloc = std::allocator<T>, typename GrowthFactor = std::ratio<2>>
+	requires std::is_trivially_copyable_v<T> && std::default_initializable<T>
+auto read_from(int fd, const Alloc& alloc = Alloc()) -> Vec<T, Alloc, GrowthFactor>{
+	VecFileHeader header;
+	detail::read_fully(fd, &header, sizeof(header));
+	header.validate<T>();
+	if(header.count > std::allocator_traits<Alloc>::max_size(alloc)){
+		throw std::runtime_error("VecIO: element count too large");
+	}
+	Vec<T, Alloc, GrowthFactor> result(static_cast<size_t>(header.count), default_init, alloc);
+	detail::read_fully(fd, result.data(), result.size() * sizeof(T));
+	return result;
+}
+
+// the elements in 'bytes', which must hold a complete Vec file, without copying them.
+// 'bytes' must outlive the span, and its elements must be suitably aligned for T.
+// Memory from a MappedVec<const std::byte>, or from operator new, always is.
+template<typename T>
+	requires std::is_trivially_copyable_v<T>
+auto view_from(std::span<const std::byte> bytes) -> std::span<const T>{
+	VecFileHeader header;
+	if(bytes.size() < sizeof(header)){
+		throw std::runtime_error("VecIO: buffer too small for a header");
+	}
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	header.validate<T>();
+	const auto available = (bytes.size() - sizeof(header)) / sizeof(T);
+	if(header.count > available){
+		throw std::runtime_error("VecIO: buffer is shorter than its header claims");
+	}
+	const std::byte* first = bytes.data() + header.data_offset;
+	if(reinterpret_cast<std::uintptr_t>(first) % alignof(T) != 0){
+		throw std::runtime_error("VecIO: buffer is not suitably aligned for T");
+	}
+	return {reinterpret_cast<const T*>(first), static_cast<size_t>(header.count)};
+}
+
+#pragma warning(pop)
@@ -0,0 +1,127 @@
+#pragma once
+#include <algorithm>      // std::all_of, std::min, std::max
+#include <array>
+#include <cstddef>
+#include <execution>      // std::is_execution_policy_v
+#include <memory>         // std::uninitialized_fill_n
+#include <numeric>        // std::iota
+#include <type_traits>
+#include <utility>        // std::forward
+#include "Vec.h"
+
+// fill, copy and compare a Vec with an execution policy, std::execution::par and friends:
+//	const Vec<float> ones = parallel_fill(std::execution::par, 100'000'000, 1.0f);
+//	const Vec<float> copy = parallel_copy(std::execution::par, ones);
+//	assert(parallel_equal(std::execution::par, copy, ones));
+// These live apart from Vec.h because <execution> isn't free: with libstdc++ the parallel
+// algorithms run on TBB, so every program that includes it has to link -ltbb. Include
+// this header where you want them, and plain Vec users don't pay for it.
+// Like every algorithm with an execution policy, if an element constructor throws
+// std::terminate is called.
+
+// the overloads taking an execution policy only go parallel from this many elements on.
+// Below ~1 MiB, waking up the other cores costs more than it saves, so smaller Vecs
+// quietly take the serial path.
+template<typename T>
+inline constexpr size_t parallel_threshold = std::max<size_t>(1, (1 << 20) / sizeof(T));
+
+namespace detail{
+template<typename P>
+concept execution_policy = std::is_execution_policy_v<std::remove_cvref_t<P>>;
+
+// splits [0, count) into (up to) 64 slices, and asks test(offset, length) about each of
+// them, spread over the cores by 'policy'. True if every slice passed. Each slice takes
+// the usual serial fast path (memcpy, memcmp, ...), which the element-wise parallel
+// algorithms would lose. 64 slices keep today's machines busy, without any allocation.
+template<typename Policy, typename Test>
+auto all_slices(Policy&& policy, size_t count, Test test) -> bool{
+	std::array<size_t, 64> slices;
+	std::iota(slices.begin(), slices.end(), size_t{0});
+	const size_t per_slice = (count + slices.size() - 1) / slices.size();
+	return std::all_of(std::forward<Policy>(policy), slices.begin(), slices.end(),
+		[&](size_t slice){
+			const size_t offset = slice * per_slice;
+			return offset >= count || test(offset, std::min(per_slice, count - offset));
+		});
+}
+
+// the same, for work that can't fail: calls work(offset, length) for every slice.
+template<typename Policy, typename Work>
+auto for_each_slice(Policy&& policy, size_t count, Work work) -> void{
+	all_slices(std::forward<Policy>(policy), count, [&](size_t offset, size_t length){
+		work(offset, length);
+		return true;
+	});
+}
+
+// builds Vecs the way Vec's own constructors do: into storage that is allocated, but not
+// constructed yet. Vec befriends it for that.
+struct vec_parallel{
+	template<typename V, typename Policy>
+	static auto fill(Policy&& policy, size_t count, const typename V::value_type& val,
+		const typename V::allocator_type& alloc) -> V{
+		V result(V::reserve_only, count, alloc);
+		if(V::plain_construct && count >= parallel_threshold<typename V::value_type>){
+			for_each_slice(std::forward<Policy>(policy), count,
+				[&](size_t offset, size_t length){
+					std::uninitialized_fill_n(result._data + offset, length, val);
+				});
+		} else{
+			result.fill_construct_n(result._data, count, val);
+		}
+		result._size = count;
+		return result;
+	}
+
+	template<typename V, typename Policy>
+	static auto copy(Policy&& policy, const V& that) -> V{
+		using T = typename V::value_type;
+		V result(V::reserve_only, that.size(),
+			V::alloc_traits::select_on_container_copy_construction(that._alloc));
+		if(V::plain_construct && that.size() >= parallel_threshold<T>){
+			for_each_slice(std::forward<Policy>(policy), that.size(),
+				[&](size_t offset, size_t length){
+					const T* first = that._data + offset;
+					result.copy_construct(first, first + length, result._data + offset);
+				});
+		} else{
+			result.copy_construct(that._data, that._data + that.size(), result._data);
+		}
+		result._size = that.size();
+		return result;
+	}
+};
+}
+
+// Vec<T, Alloc>(count, val, alloc), filled in parallel. Allocators with their own
+// construct() fill serially.
+template<detail::execution_policy Policy, std::copy_constructible T,
+	typename Alloc = std::allocator<T>>
+auto parallel_fill(Policy&& policy, size_t count, const T& val, const Alloc& alloc = Alloc())
+	-> Vec<T, Alloc>{
+	return detail::vec_parallel::fill<Vec<T, Alloc>>(std::forward<Policy>(policy), count, val,
+		alloc);
+}
+
+// a copy of 'that', made in parallel. The same rules as parallel_fill().
+template<detail::execution_policy Policy, std::copy_constructible T, typename Alloc,
+	typename GrowthFactor>
+auto parallel_copy(Policy&& policy, const Vec<T, Alloc, GrowthFactor>& that)
+	-> Vec<T, Alloc, GrowthFactor>{
+	return detail::vec_parallel::copy(std::forward<Policy>(policy), that);
+}
+
+// a == b, compared in parallel.
+// (not noexcept: the parallel algorithms may fail to allocate their own bookkeeping.)
+template<detail::execution_policy Policy, std::equality_comparable T, typename Alloc,
+	typename GrowthFactor>
+auto parallel_equal(Policy&& policy, const Vec<T, Alloc, GrowthFactor>& a,
+	const Vec<T, Alloc, GrowthFactor>& b) -> bool{
+	if(a.size() < parallel_threshold<T> || a.size() != b.size()){
+		return a == b;
+	}
+	return detail::all_slices(std::forward<Policy>(policy), a.size(),
+		[&](size_t offset, size_t length){
+			return detail::equal_n(a.data() + offset, b.data() + offset, length);
+		});
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <algorithm>      // std::max
+#include <atomic>
+#include <cstddef>
+#include <memory>         // std::allocator, std::allocator_traits
+#include <type_traits>    // std::remove_cvref_t, std::is_lvalue_reference_v
+#include <utility>        // std::forward
+#include "Vec.h"
+
+// Allocation statistics, per element type. Opt in by giving Vec an InstrumentedAllocator
+// (or use the InstrumentedVec<T> alias below). Plain Vec<T> never touches any of this, so
+// when you don't ask for instrumentation you don't pay for it: not a byte, not a cycle.
+
+// a plain copy of the counters, taken at one point in time.
+struct VecStatsSnapshot{
+	size_t allocations = 0;
+	size_t deallocations = 0;
+	size_t bytes_live = 0;
+	size_t peak_bytes = 0;
+	size_t copy_constructions = 0; // elements constructed from an lvalue T
+	size_t move_constructions = 0; // elements constructed from an rvalue T
+};
+
+// one set of counters for each element type T, shared by every instrumented Vec<T>.
+// Atomic, because Vecs on different threads report to the same counters.
+template<typename T>
+class VecStats{
+public:
+	static auto snapshot() noexcept -> VecStatsSnapshot{
+		return VecStatsSnapshot{
+			.allocations = _allocations.load(std::memory_order_relaxed),
+			.deallocations = _deallocations.load(std::memory_order_relaxed),
+			.bytes_live = _bytes_live.load(std::memory_order_relaxed),
+			.peak_bytes = _peak_bytes.load(std::memory_order_relaxed),
+			.copy_constructions = _copies.load(std::memory_order_relaxed),
+			.move_constructions = _moves.load(std::memory_order_relaxed)
+		};
+	}
+
+	// starts counting from zero again. bytes_live is left alone: that memory is still out there.
+	static auto reset() noexcept -> void{
+		_allocations = 0;
+		_deallocations = 0;
+		_peak_bytes = _bytes_live.load();
+		_copies = 0;
+		_moves = 0;
+	}
+
+	static auto on_allocate(size_t bytes) noexcept -> void{
+		++_allocations;
+		const size_t live = _bytes_live += bytes;
+		size_t peak = _peak_bytes.load(std::memory_order_relaxed);
+		while(live > peak && !_peak_bytes.compare_exchange_weak(peak, live)){
+			// peak was reloaded by the failed exchange, try again
+		}
+	}
+	static auto on_deallocate(size_t bytes) noexcept -> void{
+		++_deallocations;
+		_bytes_live -= bytes;
+	}
+	static auto on_copy() noexcept -> void{ ++_copies; }
+	static auto on_move() noexcept -> void{ ++_moves; }
+
+private:
+	static inline std::atomic<size_t> _allocations{0};
+	static inline std::atomic<size_t> _deallocations{0};
+	static inline std::atomic<size_t> _bytes_live{0};
+	static inline std::atomic<size_t> _peak_bytes{0};
+	static inline std::atomic<size_t> _copies{0};
+	static inline std::atomic<size_t> _moves{0};
+};
+
+// allocator adaptor that reports to VecStats<T>, and otherwise does whatever Base does.
+// Everything Vec allocates and constructs goes through its allocator, so this sees it all.
+// Note that an allocator with its own construct() turns off Vec's memcpy fast paths:
+// every element has to be counted. That is the price of looking, paid only when looking.
+template<typename T, typename Base = std::allocator<T>>
+class InstrumentedAllocator : public Base{
+	using base_traits = std::allocator_traits<Base>;
+
+public:
+	using value_type = T;
+
+	template<typename U>
+	struct rebind{
+		using other = InstrumentedAllocator<U, typename base_traits::template rebind_alloc<U>>;
+	};
+
+	InstrumentedAllocator() noexcept(noexcept(Base())) = default;
+	InstrumentedAllocator(const Base& base) noexcept
+		: Base(base){}
+	template<typename U, typename OtherBase>
+	InstrumentedAllocator(const InstrumentedAllocator<U, OtherBase>& that) noexcept
+		: Base(static_cast<const OtherBase&>(that)){}
+
+	auto allocate(size_t count) -> T*{
+		T* p = base_traits::allocate(base(), count);
+		VecStats<T>::on_allocate(count * sizeof(T));
+		return p;
+	}
+	auto deallocate(T* p, size_t count) noexcept -> void{
+		VecStats<T>::on_deallocate(count * sizeof(T));
+		base_traits::deallocate(base(), p, count);
+	}
+
+	// constructing a U from a single U is a copy or a move. Anything else isn't counted.
+	template<typename U, typename... Args>
+	auto construct(U* p, Args&&... args) -> void{
+		if constexpr(sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, U> && ...)){
+			if constexpr((std::is_lvalue_reference_v<Args> && ...)){
+				VecStats<U>::on_copy();
+			} else{
+				VecStats<U>::on_move();
+			}
+		}
+		using u_traits = typename base_traits::template rebind_traits<U>;
+		typename u_traits::allocator_type u_base(base());
+		u_traits::construct(u_base, p, std::forward<Args>(args)...);
+	}
+
+	auto select_on_container_copy_construction() const -> InstrumentedAllocator{
+		return InstrumentedAllocator(base_traits::select_on_container_copy_construction(base()));
+	}
+
+	template<typename U, typename OtherBase>
+	friend bool operator==(const InstrumentedAllocator& a,
+		const InstrumentedAllocator<U, OtherBase>& b) noexcept{
+		return static_cast<const Base&>(a) == static_cast<const OtherBase&>(b);
+	}
+
+private:
+	auto base() noexcept -> Base&{ return *this; }
+	auto base() const noexcept -> const Base&{ return *this; }
+};
+
+// a Vec that reports to VecStats<T>. Same interface, same behavior, just counted.
+template<typename T>
+using InstrumentedVec = Vec<T, InstrumentedAllocator<T>>;
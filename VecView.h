@@ -0,0 +1,138 @@
+#pragma once
+#include <cassert>        // assert, catching bugs in debug builds
+#include <concepts>
+#include <cstddef>
+#include <iterator>       // std::next
+#include <ranges>         // std::ranges::contiguous_range, std::ranges::data
+#include <span>
+#include <stdexcept>      // std::out_of_range
+#include <type_traits>
+#include "Vec.h"          // detail::equal_n, detail::compare_three_way_n
+
+#pragma warning(push)
+#pragma warning(disable : 26446) // bounds.4 - subscript operator use
+#pragma warning(disable : 26481) // bounds.1 - pointer arithmetic, we manage raw storage ourselves
+
+// VecView<T> is a non-owning window onto contiguous T's: a pointer and a size, nothing more.
+// It costs nothing to create or copy, so hand slices of a Vec from one stage of the
+// pipeline to the next as VecViews, instead of copying them into new Vecs.
+// VecView<const T> only reads, VecView<T> can write through to the elements.
+// Like any view it doesn't keep its elements alive: the Vec it looks at must outlive it,
+// and anything that reallocates the Vec (push_back, reserve, ...) leaves it dangling.
+template<typename T>
+class VecView{
+	// 'From' elements can be viewed as T's if a pointer to an array of them converts.
+	// That lets T* become const T*, but not Derived* become Base*.
+	template<typename From>
+	static constexpr bool viewable_as = std::is_convertible_v<From(*)[], T(*)[]>;
+
+public:
+	using value_type = std::remove_cv_t<T>;
+	using iterator = T*;
+	using const_iterator = const T*;
+	using size_type = size_t;
+	using reference = T&;
+	using const_reference = const T&;
+	using pointer = T*;
+	using const_pointer = const T*;
+
+	constexpr VecView() noexcept = default;
+
+	constexpr VecView(pointer data, size_type count) noexcept
+		: _data(data)
+		, _size(count){
+		assert((data || count == 0) && "VecView<T>: null data with a non-zero size");
+	}
+
+	// implicit from any contiguous container we can see T's in: Vec, SmallVec, MappedVec,
+	// std::vector, std::array... Only lvalues, a temporary would dangle right away.
+	template<std::ranges::contiguous_range Container>
+		requires std::ranges::sized_range<Container>
+			&& (!std::is_same_v<std::remove_cvref_t<Container>, VecView>)
+			&& viewable_as<std::remove_reference_t<std::ranges::range_reference_t<Container>>>
+	constexpr VecView(Container& c) noexcept
+		: VecView(std::ranges::data(c), static_cast<size_type>(std::ranges::size(c))){}
+
+	constexpr VecView(std::span<T> s) noexcept
+		: VecView(s.data(), s.size()){}
+
+	// VecView<T> converts to VecView<const T>.
+	template<typename U> requires (!std::is_same_v<U, T>) && viewable_as<U>
+	constexpr VecView(VecView<U> that) noexcept
+		: VecView(that.data(), that.size()){}
+
+	constexpr operator std::span<T>() const noexcept{ return {_data, _size}; }
+
+	bool operator==(const VecView& that) const noexcept requires std::equality_comparable<T>{
+		if(size() != that.size()) return false;
+		return detail::equal_n<value_type>(data(), that.data(), size());
+	}
+	auto operator<=>(const VecView& that) const noexcept requires std::three_way_comparable<T>{
+		return detail::compare_three_way_n<value_type>(data(), size(), that.data(), that.size());
+	}
+
+	// a view is like a pointer: its constness is its own, not its elements'.
+	constexpr auto data() const noexcept -> pointer{ return _data; }
+	constexpr auto begin() const noexcept -> iterator{ return data(); }
+	constexpr auto end() const noexcept -> iterator{ return std::next(data(), size()); }
+	constexpr auto size() const noexcept -> size_type{ return _size; }
+	constexpr auto empty() const noexcept -> bool{ return size() == 0; }
+
+	constexpr auto operator[](size_type index) const noexcept -> reference{
+		assert(index < size() && "VecView<T>: Index out of bounds in operator[]");
+		return _data[index];
+	}
+	constexpr auto front() const noexcept -> reference{
+		assert(!empty() && "Calling front() on an empty VecView is undefined behavior!");
+		return (*this)[0];
+	}
+	constexpr auto back() const noexcept -> reference{
+		assert(!empty() && "Calling back() on an empty VecView is undefined behavior!");
+		return (*this)[size() - 1];
+	}
+	constexpr auto at(size_type index) const -> reference{
+		if(index < size()){
+			return (*this)[index];
+		}
+		throw std::out_of_range("VecView<T>: Index out of bounds in at()");
+	}
+
+	// the 'count' elements starting at 'offset'. Both must be in range.
+	constexpr auto subview(size_type offset, size_type count) const noexcept -> VecView{
+		assert(offset <= size() && count <= size() - offset
+			&& "VecView<T>: subview out of bounds");
+		return {_data + offset, count};
+	}
+	// everything from 'offset' to the end.
+	constexpr auto subview(size_type offset) const noexcept -> VecView{
+		assert(offset <= size() && "VecView<T>: subview out of bounds");
+		return subview(offset, size() - offset);
+	}
+	constexpr auto first(size_type count) const noexcept -> VecView{
+		assert(count <= size() && "VecView<T>: first() out of bounds");
+		return subview(0, count);
+	}
+	constexpr auto last(size_type count) const noexcept -> VecView{
+		assert(count <= size() && "VecView<T>: last() out of bounds");
+		return subview(size() - count, count);
+	}
+
+private:
+	pointer _data = nullptr;
+	size_t _size = 0;
+};
+
+// deduce VecView<T> or VecView<const T> from what we are looking at.
+template<std::ranges::contiguous_range Container>
+VecView(Container&) -> VecView<std::remove_reference_t<std::ranges::range_reference_t<Container>>>;
+template<typename T>
+VecView(T*, size_t) -> VecView<T>;
+
+// VecViews are views, as far as the ranges library is concerned: cheap to copy, and
+// safe to return from a function even when made from a temporary VecView.
+template<typename T>
+inline constexpr bool std::ranges::enable_view<VecView<T>> = true;
+template<typename T>
+inline constexpr bool std::ranges::enable_borrowed_range<VecView<T>> = true;
+
+#pragma warning(pop)
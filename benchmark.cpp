@@ -0,0 +1,361 @@
+// Microbenchmarks for Vec<T>, measured side by side with std::vector<T>.
+// Build the RAII_2025_Bench project in Release, then run it from a terminal:
+//	RAII_2025_Bench [--filter=<substring>] [--min-time=<seconds per measurement>]
+// Every row runs the same operation on both containers and reports ns/op, the
+// ratio (above 1.0 means Vec is slower) and Vec's throughput, so regressions stand out.
+// Timings are only as good as the machine is quiet: close the browser, plug in the laptop.
+#include <algorithm>      // std::sort, std::lexicographical_compare_three_way
+#include <atomic>         // std::atomic_signal_fence
+#include <chrono>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>         // std::printf
+#include <cstring>        // std::memcpy
+#include <cstdlib>        // std::strtod
+#include <execution>      // std::execution::par_unseq
+#include <string>
+#include <string_view>
+#include <type_traits>    // std::type_identity
+#include <vector>
+#include "Vec.h"
+#include "PoolAllocator.h"
+#include "ReallocAllocator.h"
+#include "VecParallel.h"
+
+namespace{
+
+// keep the optimizer from deleting the work we are trying to measure.
+const void* volatile g_sink = nullptr;
+template<typename T>
+void do_not_optimize(const T& value){
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	g_sink = &value;
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+struct Options{
+	double min_time = 0.1; // seconds
+	std::string_view filter;
+};
+Options g_options;
+
+// runs 'op' in ever larger batches until a batch takes at least min_time. Returns ns/op.
+template<typename Op>
+auto measure(Op&& op) -> double{
+	using clock = std::chrono::steady_clock;
+	for(size_t iterations = 1;; iterations *= 2){
+		const auto start = clock::now();
+		for(size_t i = 0; i < iterations; ++i){
+			op();
+		}
+		const std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+		if(elapsed.count() >= g_options.min_time * 1e9 || iterations >= (size_t{1} << 40)){
+			return elapsed.count() / static_cast<double>(iterations);
+		}
+	}
+}
+
+// for operations that need fresh input every time (sort, clear): time setup + op,
+// then subtract the time of setup alone.
+template<typename Setup, typename Op>
+auto measure_with_setup(Setup&& setup, Op&& op) -> double{
+	const double both = measure([&]{ auto input = setup(); op(input); do_not_optimize(input); });
+	const double setup_only = measure([&]{ auto input = setup(); do_not_optimize(input); });
+	return std::max(both - setup_only, 0.0);
+}
+
+auto selected(const std::string& name) -> bool{
+	return name.find(g_options.filter) != std::string::npos;
+}
+
+auto report(const std::string& name, double vec_ns, double std_ns, double bytes_per_op) -> void{
+	const double mb_per_s = vec_ns > 0.0 ? bytes_per_op / vec_ns * 1e9 / (1024.0 * 1024.0) : 0.0;
+	std::printf("%-42s %14.1f %14.1f %8.2f %14.1f\n",
+		name.c_str(), vec_ns, std_ns, std_ns > 0.0 ? vec_ns / std_ns : 0.0, mb_per_s);
+}
+
+// a chunky, trivially copyable element type.
+struct Blob64{
+	std::uint64_t words[8];
+	auto operator<=>(const Blob64&) const = default;
+};
+
+template<typename T>
+auto make(size_t i) -> T{
+	if constexpr(std::is_same_v<T, Blob64>){
+		return Blob64{{i, i ^ 0x5555, i * 3, 0, 0, 0, 0, i}};
+	} else{
+		return static_cast<T>(i);
+	}
+}
+
+template<typename T> constexpr const char* type_name = "?";
+template<> constexpr const char* type_name<std::uint8_t> = "u8";
+template<> constexpr const char* type_name<int> = "int";
+template<> constexpr const char* type_name<Blob64> = "blob64";
+
+// pseudo-random, but the same for every run and both containers.
+template<typename T>
+auto random_source(size_t count) -> std::vector<T>{
+	std::vector<T> source;
+	source.reserve(count);
+	std::uint32_t seed = 2025;
+	for(size_t i = 0; i < count; ++i){
+		seed = seed * 1664525u + 1013904223u;
+		source.push_back(make<T>(seed >> 8));
+	}
+	return source;
+}
+
+// runs 'bench' once for Vec and once for std::vector, and prints a row.
+template<typename T, typename Bench>
+auto compare(const std::string& op, size_t count, double bytes_per_op, Bench&& bench) -> void{
+	const std::string name = op + "/" + type_name<T> + "/" + std::to_string(count);
+	if(!selected(name)){
+		return;
+	}
+	const double vec_ns = bench(std::type_identity<Vec<T>>{});
+	const double std_ns = bench(std::type_identity<std::vector<T>>{});
+	report(name, vec_ns, std_ns, bytes_per_op);
+}
+
+template<typename T>
+auto run_for(size_t count) -> void{
+	const auto source = random_source<T>(count);
+	const double bytes = static_cast<double>(count * sizeof(T));
+
+	compare<T>("construct(count)", count, bytes, [&]<typename C>(std::type_identity<C>){
+		return measure([&]{ C c(count); do_not_optimize(c); });
+	});
+	compare<T>("construct(count, value)", count, bytes, [&]<typename C>(std::type_identity<C>){
+		return measure([&]{ C c(count, make<T>(42)); do_not_optimize(c); });
+	});
+	compare<T>("construct(first, last)", count, bytes, [&]<typename C>(std::type_identity<C>){
+		return measure([&]{ C c(source.begin(), source.end()); do_not_optimize(c); });
+	});
+	compare<T>("copy", count, bytes, [&]<typename C>(std::type_identity<C>){
+		const C original(source.begin(), source.end());
+		return measure([&]{ C c = original; do_not_optimize(c); });
+	});
+	compare<T>("move (ctor + assign back)", count, 0.0, [&]<typename C>(std::type_identity<C>){
+		C original(source.begin(), source.end());
+		return measure([&]{
+			C moved = std::move(original);
+			do_not_optimize(moved);
+			original = std::move(moved);
+		});
+	});
+	// identical contents is the worst case for both: every element has to be compared.
+	compare<T>("operator==", count, 2 * bytes, [&]<typename C>(std::type_identity<C>){
+		const C a(source.begin(), source.end());
+		const C b = a;
+		return measure([&]{ const bool equal = (a == b); do_not_optimize(equal); });
+	});
+	compare<T>("operator<=>", count, 2 * bytes, [&]<typename C>(std::type_identity<C>){
+		const C a(source.begin(), source.end());
+		const C b = a;
+		return measure([&]{ const auto order = (a <=> b); do_not_optimize(order); });
+	});
+	compare<T>("std::sort", count, bytes, [&]<typename C>(std::type_identity<C>){
+		return measure_with_setup(
+			[&]{ return C(source.begin(), source.end()); },
+			[](C& c){ std::sort(c.begin(), c.end()); });
+	});
+	// a block of 'count' elements into the middle, and out again: the tail moves once each.
+	compare<T>("insert(mid, first, last) + erase", count, 2 * bytes,
+		[&]<typename C>(std::type_identity<C>){
+			C c(source.begin(), source.end());
+			c.reserve(2 * count);
+			return measure([&]{
+				const auto at = c.insert(c.begin() + count / 2, source.begin(), source.end());
+				c.erase(at, at + count);
+				do_not_optimize(c);
+			});
+		});
+	compare<T>("erase_if (every other)", count, bytes, [&]<typename C>(std::type_identity<C>){
+		return measure_with_setup(
+			[&]{ return C(source.begin(), source.end()); },
+			[](C& c){
+				using std::erase_if; // the std::erase_if two-step, like swap: ADL finds Vec's
+				bool odd = false;
+				erase_if(c, [&](const T&){ return odd = !odd; });
+			});
+	});
+	// note: Vec::clear() gives back its buffer, std::vector::clear() keeps it.
+	compare<T>("clear()", count, 0.0, [&]<typename C>(std::type_identity<C>){
+		return measure_with_setup(
+			[&]{ return C(source.begin(), source.end()); },
+			[](C& c){ c.clear(); });
+	});
+}
+
+template<typename T>
+auto run_initializer_list() -> void{
+	constexpr size_t count = 8;
+	const double bytes = static_cast<double>(count * sizeof(T));
+	compare<T>("construct({...})", count, bytes, [&]<typename C>(std::type_identity<C>){
+		return measure([&]{
+			C c{make<T>(1), make<T>(2), make<T>(3), make<T>(4),
+				make<T>(5), make<T>(6), make<T>(7), make<T>(8)};
+			do_not_optimize(c);
+		});
+	});
+}
+
+// what the compile-time dispatched fast paths in Vec's comparisons buy us, compared
+// to the element-by-element loops they replaced. And what the parallel overloads, and
+// growing with realloc, buy us.
+template<typename T>
+auto run_fast_paths(size_t count) -> void{
+	const std::string suffix = std::string("/") + type_name<T> + "/" + std::to_string(count);
+	const Vec<T> a(count, make<T>(7));
+	const Vec<T> b = a;
+	const double bytes = static_cast<double>(2 * count * sizeof(T));
+
+	if(const std::string name = "operator== vs loop" + suffix; selected(name)){
+		const double fast = measure([&]{ const bool eq = (a == b); do_not_optimize(eq); });
+		const double loop = measure([&]{
+			bool eq = a.size() == b.size();
+			for(size_t i = 0; eq && i < a.size(); ++i){
+				eq = a[i] == b[i];
+			}
+			do_not_optimize(eq);
+		});
+		report(name, fast, loop, bytes);
+	}
+	if(const std::string name = "operator<=> vs loop" + suffix; selected(name)){
+		const double fast = measure([&]{ const auto order = (a <=> b); do_not_optimize(order); });
+		const double loop = measure([&]{
+			const auto order = std::lexicographical_compare_three_way(
+				a.begin(), a.end(), b.begin(), b.end());
+			do_not_optimize(order);
+		});
+		report(name, fast, loop, bytes);
+	}
+
+	// the parallel overloads, against their serial selves. Below parallel_threshold<T>
+	// these should come out even: both run the serial code.
+	if(const std::string name = "parallel_fill vs construct(n, value)" + suffix; selected(name)){
+		const double par = measure([&]{
+			const Vec<T> c = parallel_fill(std::execution::par_unseq, count, make<T>(7));
+			do_not_optimize(c);
+		});
+		const double serial = measure([&]{
+			const Vec<T> c(count, make<T>(7));
+			do_not_optimize(c);
+		});
+		report(name, par, serial, bytes / 2);
+	}
+	if(const std::string name = "parallel_copy vs copy" + suffix; selected(name)){
+		const double par = measure([&]{
+			const Vec<T> c = parallel_copy(std::execution::par_unseq, a);
+			do_not_optimize(c);
+		});
+		const double serial = measure([&]{ const Vec<T> c(a); do_not_optimize(c); });
+		report(name, par, serial, bytes / 2);
+	}
+	if(const std::string name = "parallel_equal vs operator==" + suffix; selected(name)){
+		const double par = measure([&]{
+			const bool eq = parallel_equal(std::execution::par_unseq, a, b);
+			do_not_optimize(eq);
+		});
+		const double serial = measure([&]{ const bool eq = (a == b); do_not_optimize(eq); });
+		report(name, par, serial, bytes);
+	}
+
+	// filling from a C API: zeroed by the count ctor and then overwritten, or written once.
+	if(const std::string name = "resize_and_overwrite vs Vec(n) + copy" + suffix; selected(name)){
+		const double fused = measure([&]{
+			Vec<T> c;
+			c.resize_and_overwrite(count, [&](T* p, size_t n){
+				std::memcpy(p, a.data(), n * sizeof(T));
+				return n;
+			});
+			do_not_optimize(c);
+		});
+		const double zeroed = measure([&]{
+			Vec<T> c(count);
+			std::memcpy(c.data(), a.data(), count * sizeof(T));
+			do_not_optimize(c);
+		});
+		report(name, fused, zeroed, bytes / 2);
+	}
+
+	// a Vec per request: the pool turns malloc and free into popping and pushing a list.
+	if(const std::string name = "PoolVec vs Vec (create + destroy)" + suffix; selected(name)){
+		const double pooled = measure([&]{
+			const PoolVec<T> c(count, default_init);
+			do_not_optimize(c);
+		});
+		const double heap = measure([&]{
+			const Vec<T> c(count, default_init);
+			do_not_optimize(c);
+		});
+		report(name, pooled, heap, 0.0);
+	}
+
+	// every reallocation of a plain Vec copies all it holds; realloc often doesn't have to.
+	if(const std::string name = "push_back(realloc) vs Vec" + suffix; selected(name)){
+		const auto fill = [&]<typename C>(std::type_identity<C>){
+			return measure([&]{
+				C c;
+				for(size_t i = 0; i < count; ++i){
+					c.push_back(make<T>(i));
+				}
+				do_not_optimize(c);
+			});
+		};
+		report(name, fill(std::type_identity<ReallocVec<T>>{}),
+			fill(std::type_identity<Vec<T>>{}), bytes / 2);
+	}
+}
+
+auto print_header(const char* first, const char* second) -> void{
+	std::printf("\n%-42s %14s %14s %8s %14s\n", "benchmark", first, second, "ratio", "MB/s");
+	std::printf("%s\n", std::string(96, '-').c_str());
+}
+
+auto parse_options(int argc, char** argv) -> void{
+	for(int i = 1; i < argc; ++i){
+		const std::string_view arg = argv[i];
+		if(arg.starts_with("--filter=")){
+			g_options.filter = arg.substr(9);
+		} else if(arg.starts_with("--min-time=")){
+			g_options.min_time = std::strtod(argv[i] + 11, nullptr);
+		} else{
+			std::printf("usage: %s [--filter=<substring>] [--min-time=<seconds>]\n", argv[0]);
+			std::exit(1);
+		}
+	}
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+	parse_options(argc, argv);
+#if !defined(NDEBUG)
+	std::printf("warning: this is a debug build, the numbers below mean nothing.\n");
+#endif
+	constexpr size_t counts[] = {16, 4096, size_t{1} << 20};
+
+	print_header("Vec ns/op", "vector ns/op");
+	for(const size_t count : counts){
+		run_for<std::uint8_t>(count);
+		run_for<int>(count);
+		run_for<Blob64>(count);
+	}
+	run_initializer_list<std::uint8_t>();
+	run_initializer_list<int>();
+	run_initializer_list<Blob64>();
+
+	print_header("fast ns/op", "loop ns/op");
+	for(const size_t count : counts){
+		run_fast_paths<std::uint8_t>(count);
+		run_fast_paths<int>(count);
+	}
+	return 0;
+}
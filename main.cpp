@@ -1,180 +1,148 @@
-#include <algorithm>      // std::fill, std::copy, std::equal, std::lexicographical_compare_three_way
+#include <algorithm>      // std::all_of, std::sort, std::lexicographical_compare_three_way
+#include <array>
+#include <atomic>         // std::atomic<bool>
 #include <cassert>        // assert, catching bugs in debug builds
-#include <compare>        // three-way comparison
-#include <concepts>       // std::regular, std::three_way_comparable
-#include <initializer_list>
-#include <iterator>       // std::distance
+#include <concepts>       // std::regular
+#include <cstddef>        // std::byte
+#include <cstdint>        // std::uint8_t
+#include <cstdio>         // std::tmpfile, std::fread, std::fwrite
+#include <cstring>        // std::memcpy
+#include <execution>      // std::execution::par
+#include <filesystem>
+#include <forward_list>
+#include <fstream>        // std::ofstream
+#include <functional>     // std::greater
+#include <iterator>       // std::istream_iterator
+#include <limits>         // std::numeric_limits
+#include <numeric>        // std::accumulate
+#include <ranges>         // std::views::istream
+#include <span>
+#include <sstream>        // std::istringstream
 #include <memory>         // std::unique_ptr
-#include <stdexcept>      // std::out_of_range
-#include <utility>        // std::swap, std::exchange
-
-#pragma warning(push)
-#pragma warning(disable : 26446) // bounds.4 - subscript operator use
-
-template<typename T>
-class Vec{
-	static_assert(std::regular<T>, "Vec<T> requires T to be regular");
-
-public:
-	using value_type = T;
-	using iterator = T*;
-	using const_iterator = const T*;
-	using size_type = size_t;
-	using reference = T&;
-	using const_reference = const T&;
-	using pointer = T*;
-	using const_pointer = const T*;
-
-	Vec() noexcept = default; 
-	~Vec() noexcept = default; //default destructor is ideal, unique_ptr will clean up.
-	
-	// count constructor, allocates 'count' default-constructed T's.
-	// this is the only constructor that allocates memory.
-	// all other ctors delegate to this one.
-	explicit Vec(size_type count)
-		: _data(count ? std::make_unique<value_type[]>(count) : nullptr)
-		, _size(count){}
-
-	// fill constructor: constructs 'count' copies of 'val'
-	Vec(size_type count, const value_type& val)
-		: Vec(count) // delegate to count ctor for the allocation
-	{
-		std::fill(begin(), end(), val);
-	}
-
-	// range constructor, accepting a pair of forward iterators
-	// notice that we are constraining the template parameter using a concept!
-	template<std::forward_iterator It>
-	Vec(It first, It last)
-		: Vec(std::ranges::distance(first, last)){
-		[[gsl::suppress(stl.1, "copy destination is sized correctly by the delegating constructor")]]
-		std::copy(first, last, begin());
-	}
-
-	Vec(std::initializer_list<value_type> l)
-		: Vec(l.begin(), l.end()) // delegate to the range ctor
-	{}
-
-	// copy ctor
-	Vec(const Vec& that)
-		: Vec(that.begin(), that.end()) // delegate to range ctor
-	{}
-
-	// move ctor
-	Vec(Vec&& that) noexcept
-		: _data(std::exchange(that._data, nullptr))
-		, _size(std::exchange(that._size, 0)){}
-
-	// assignment operator using the copy-and-swap idiom, with a twist.
-	// 'that' is passed by-value, using either copy- or move-construction.
-	// Provides the strong guarantee and is kind of noexcept, as the argument
-	// is constructed before entering the function body. :P 
-	Vec& operator=(Vec&& that) noexcept{
-		swap(that);
-		return *this;
+#include <memory_resource> // std::pmr::monotonic_buffer_resource
+#include <stdexcept>      // std::out_of_range, std::runtime_error
+#include <string>
+#include <thread>         // std::jthread
+#include <type_traits>
+#include <utility>        // std::move, std::as_const
+#include <vector>
+#include "Vec.h"
+#include "AlignedVec.h"
+#include "ConcurrentVec.h"
+#include "CowVec.h"
+#include "MappedVec.h"
+#include "PageAllocator.h"
+#include "PoolAllocator.h"
+#include "ReallocAllocator.h"
+#include "SmallVec.h"
+#include "SoaVec.h"
+#include "VecIO.h"
+#include "VecParallel.h"
+#include "VecStats.h"
+#include "VecView.h"
+
+#if defined(_WIN32)
+#include <fcntl.h>        // _O_* flags
+#include <io.h>           // _open, _close, _lseek
+#include <sys/stat.h>     // _S_IREAD, _S_IWRITE
+#else
+#include <fcntl.h>        // open
+#include <unistd.h>       // close, lseek
+#endif
+
+// opens 'path' for reading and writing, creating it if need be. Just enough for our tests.
+static auto open_for_test(const std::filesystem::path& path) -> int{
+#if defined(_WIN32)
+	int fd = -1;
+	_wsopen_s(&fd, path.c_str(), _O_RDWR | _O_CREAT | _O_TRUNC | _O_BINARY, _SH_DENYNO,
+		_S_IREAD | _S_IWRITE);
+	return fd;
+#else
+	return ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+#endif
+}
+static auto rewind_for_test(int fd) -> void{
+#if defined(_WIN32)
+	::_lseek(fd, 0, SEEK_SET);
+#else
+	::lseek(fd, 0, SEEK_SET);
+#endif
+}
+static auto close_for_test(int fd) -> void{
+#if defined(_WIN32)
+	::_close(fd);
+#else
+	::close(fd);
+#endif
+}
+
+// a regular type that counts its special member calls, and can be told to throw
+// on a given copy. Lets us verify how Vec constructs and destroys its elements.
+struct Tracked{
+	static inline int default_ctors = 0;
+	static inline int copy_ctors = 0;
+	static inline int copy_assigns = 0;
+	static inline int live = 0;
+	static inline int throw_countdown = -1; // throw when this hits zero. negative = never.
+
+	static void reset() noexcept{
+		default_ctors = copy_ctors = copy_assigns = 0;
+		throw_countdown = -1;
 	}
 
-	Vec& operator=(const Vec& that){
-		auto temp(that);
-		swap(temp);
+	int value = 0;
+
+	Tracked() noexcept{ ++default_ctors; ++live; }
+	Tracked(int v) noexcept : value(v){ ++live; }
+	Tracked(const Tracked& that) : value(that.value){
+		if(throw_countdown >= 0 && throw_countdown-- == 0){
+			throw std::runtime_error("Tracked: copy failed on purpose");
+		}
+		++copy_ctors;
+		++live;
+	}
+	Tracked& operator=(const Tracked& that) noexcept{
+		value = that.value;
+		++copy_assigns;
 		return *this;
 	}
+	~Tracked() noexcept{ --live; }
+	bool operator==(const Tracked&) const noexcept = default;
+};
 
-	//equality operator, to satisfy std::regular
-	bool operator==(const Vec& that) const noexcept{
-		if(size() != that.size()) return false;
-		return std::ranges::equal(*this, that);
-	}
-		
-	//three-way comparison operator, to generate all the other comparison operators for us!
-	// ... but does require that T is itself three-way comparable. Might be too much to ask.
-	auto operator<=>(const Vec& that) const noexcept {
-		return std::lexicographical_compare_three_way(
-			begin(), end(),
-			that.begin(), that.end()		
-		);
-	}
-
-	//the expected container interface, as per cppreference on std::vector:	
-	auto data() noexcept		-> pointer			{ return _data.get(); }
-	auto data() const noexcept	-> const_pointer	{ return _data.get(); }
-
-	auto begin() noexcept		-> iterator			{ return data(); };
-	auto begin() const noexcept -> const_iterator	{ return data(); };
-	
-	auto end() noexcept			-> iterator			{ return std::next(data(), size()); }
-	auto end() const noexcept	-> const_iterator	{ return std::next(data(), size()); }
-	
-	auto size() const noexcept	-> size_type		{ return _size; }	
-	auto empty() const noexcept -> bool				{ return size() == 0; }
-	
-	auto clear() noexcept		-> void				{ *this = {}; } 
-	// noexcept is correct here.
-	// clear() assigns a default-constructed Vec to itself. This cannot throw:
-	// our default ctor is noexcept, and the parameter to operator=
-	// is move-constructed with no allocations.
-		
-	auto operator[](size_type index) noexcept -> reference {
-		assert(index < size() && "Vec<T>: Index out of bounds in operator[]");
-		return _data[index];
-	}	
-	auto operator[](size_type index) const noexcept -> const_reference{
-		assert(index < size() && "Vec<T>: Index out of bounds in operator[]");
-		return _data[index];
-	}
-
-	auto front() noexcept -> reference{
-		assert(!empty() && "Calling front() on an empty vec is undefined behavior!");
-		return (*this)[0]; //use operator[] for all index accesses.
-	}
-	auto front() const noexcept -> const_reference{
-		assert(!empty() && "Calling front() on an empty vec is undefined behavior!");
-		return (*this)[0];
-	}
-
-	auto back() noexcept -> reference{
-		assert(!empty() && "Calling back() on an empty vec is undefined behavior!");
-		return (*this)[size() - 1];
-	}
-	auto back() const noexcept -> const_reference{
-		assert(!empty() && "Calling back() on an empty vec is undefined behavior!");
-		return (*this)[size() - 1];
-	}	
-
-	auto at(size_type index) -> reference{
-		if(index < size()){
-			return (*this)[index];
-		}
-		throw std::out_of_range("Vec<T>: Index out of bounds in at()");
-	}
-	auto at(size_type index) const -> const_reference{
-		if(index < size()){
-			return (*this)[index];
-		}
-		throw std::out_of_range("Vec<T>: Index out of bounds in at()");
-	}
-
-	auto swap(Vec& that) noexcept -> void{
-		using std::swap; //std::swap two-step, to let us use ADL.
-		swap(_data, that._data);
-		swap(_size, that._size);
-	}
-	//two-argument swap function as friend
-	friend auto swap(Vec& a, Vec& b) noexcept -> void{
-		a.swap(b); //delegate to the member version
-	}
-
-private:	
-	std::unique_ptr<value_type[]> _data = nullptr;
-	size_t _size = 0;
+// a type with no default constructor, like most of our message types.
+struct Message{
+	explicit Message(int id_) noexcept : id(id_){}
+	int id;
+	auto operator<=>(const Message&) const noexcept = default;
 };
 
+// owns a heap int, and says it is trivially relocatable: moving its bytes elsewhere moves
+// the ownership along. Counts the live ones, so we can see Vec doesn't destroy the originals.
+struct Owner{
+	static inline int live = 0;
 
-#pragma warning(pop)
+	explicit Owner(int v) : value(std::make_unique<int>(v)){ ++live; }
+	Owner(Owner&& that) noexcept : value(std::move(that.value)){ ++live; }
+	~Owner() noexcept{ --live; }
+
+	std::unique_ptr<int> value;
+};
+template<>
+struct is_trivially_relocatable<Owner> : std::true_type{};
+
+// whether V offers resize_and_overwrite.
+template<typename V>
+concept overwritable = requires(V v, size_t (*op)(typename V::pointer, size_t)){
+	v.resize_and_overwrite(1, op);
+};
 
 int main(){
 	//check that Vec<T> is a regular type, using the std::regular concept
 	static_assert(std::regular<Vec<int>>, "Vec<T> should be regular");
+	// ... but only as regular as its elements
+	static_assert(!std::copyable<Vec<std::unique_ptr<int>>>, "move-only T, move-only Vec");
+	static_assert(std::movable<Vec<std::unique_ptr<int>>>);
 
   // 1) Default construction
 	{
@@ -310,5 +278,1345 @@ int main(){
 		assert(v.data() == nullptr);
 	}
 
+	// 11) push_back / emplace_back with geometric growth, reserve, shrink_to_fit
+	{
+		Vec<int> v;
+		size_t reallocations = 0;
+		for(int i = 0; i < 1'000'000; ++i){
+			const auto* before = v.data();
+			v.push_back(i);
+			reallocations += (v.data() != before);
+		}
+		assert(v.size() == 1'000'000);
+		assert(v.capacity() >= v.size());
+		assert(v.front() == 0 && v.back() == 999'999);
+		assert(reallocations < 25 && "growth should be geometric, not linear");
+
+		v.shrink_to_fit();
+		assert(v.capacity() == v.size());
+
+		// pushing an element of the Vec itself must survive the reallocation
+		v.push_back(v[0]);
+		assert(v.back() == 0);
+
+		Vec<int> r;
+		r.reserve(10);
+		assert(r.capacity() == 10 && r.empty());
+		const auto* reserved = r.data();
+		for(int i = 0; i < 10; ++i){
+			r.emplace_back(i);
+		}
+		assert(r.data() == reserved && "no reallocation within reserved capacity");
+		assert(r == (Vec<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+
+		Vec<int, std::allocator<int>, std::ratio<3, 2>> slow{1};
+		slow.push_back(2);
+		assert(slow.capacity() == 2); // 1 * 1.5 rounds down to 1, but we always grow by one
+		slow.push_back(3);
+		assert(slow.capacity() == 3);
+		slow.push_back(4);
+		assert(slow.capacity() == 4); // 3 * 1.5 rounds down to 4
+
+		r.clear();
+		r.shrink_to_fit();
+		assert(r.capacity() == 0 && r.data() == nullptr);
+	}
+
+	// 12) count constructor value-initializes, default_init leaves it to the caller
+	{
+		Vec<int> zeroed(4);
+		assert(std::ranges::all_of(zeroed, [](int x){ return x == 0; }));
+
+		Vec<int> raw(4, default_init);
+		assert(raw.size() == 4 && raw.capacity() == 4);
+		for(size_t i = 0; i < raw.size(); ++i){
+			raw[i] = static_cast<int>(i); // write before read
+		}
+		assert(raw == (Vec<int>{0, 1, 2, 3}));
+
+		Vec<int> none(0, default_init);
+		assert(none.empty() && none.data() == nullptr);
+	}
+
+	// 13) copy, fill and range construction build each element exactly once
+	{
+		Tracked::reset();
+		Vec<Tracked> a(3, Tracked{7});
+		assert(Tracked::copy_ctors == 3);
+		Vec<Tracked> b = a;
+		assert(b == a);
+		assert(Tracked::copy_ctors == 6);
+		assert(Tracked::default_ctors == 0 && "no default-construct-then-assign");
+		assert(Tracked::copy_assigns == 0);
+
+		// a copy that throws halfway leaves nothing behind
+		const int live_before = Tracked::live;
+		Tracked::throw_countdown = 2;
+		bool threw = false;
+		try{
+			Vec<Tracked> c = a;
+		} catch(const std::runtime_error&){
+			threw = true;
+		}
+		assert(threw);
+		assert(Tracked::live == live_before && "partially built elements must be destroyed");
+		Tracked::reset();
+
+		// trivially copyable T takes the memcpy path, with the same result
+		Vec<int> ints{1, 2, 3, 4, 5};
+		Vec<int> copy = ints;
+		assert(copy == ints && copy.data() != ints.data());
+	}
+
+	// 14) move-only and non-default-constructible element types, stored by value
+	{
+		Vec<std::unique_ptr<int>> owners;
+		for(int i = 0; i < 100; ++i){
+			owners.push_back(std::make_unique<int>(i)); // grows by moving, never copying
+		}
+		assert(owners.size() == 100);
+		assert(*owners.front() == 0 && *owners.back() == 99);
+		Vec<std::unique_ptr<int>> stolen = std::move(owners);
+		assert(owners.empty() && *stolen[42] == 42);
+
+		static_assert(!std::is_constructible_v<Vec<Message>, size_t>,
+			"no count ctor without a default ctor");
+		Vec<Message> inbox(2, Message{7});
+		inbox.emplace_back(9);
+		assert(inbox.size() == 3 && inbox.back().id == 9);
+		Vec<Message> copy = inbox;
+		assert(copy == inbox);
+		assert(inbox < (Vec<Message>{Message{8}}));
+	}
+
+	// 15) allocator-aware: a pmr::Vec lives entirely in its arena
+	{
+		std::byte buffer[1024];
+		// null_memory_resource upstream: any allocation outside the buffer throws
+		std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+			std::pmr::null_memory_resource());
+		const auto in_arena = [&](const void* p){
+			return p >= static_cast<const void*>(buffer)
+				&& p < static_cast<const void*>(buffer + sizeof(buffer));
+		};
+
+		// (plus the iterator generation counter, when iterators are checked)
+		static_assert(sizeof(Vec<int>) == (3 + VEC_CHECKED_ITERATORS) * sizeof(void*),
+			"std::allocator takes up no space");
+
+		pmr::Vec<int> v(&arena);
+		for(int i = 0; i < 20; ++i){
+			v.push_back(i);
+		}
+		assert(v.size() == 20 && v.back() == 19);
+		assert(in_arena(v.data()));
+		assert(v.get_allocator().resource() == &arena);
+
+		// copies don't inherit the arena (pmr allocators don't propagate on copy)...
+		pmr::Vec<int> heap_copy = v;
+		assert(heap_copy == v);
+		assert(heap_copy.get_allocator().resource() == std::pmr::get_default_resource());
+		// ... unless asked to
+		pmr::Vec<int> arena_copy(v, &arena);
+		assert(arena_copy == v && in_arena(arena_copy.data()));
+
+		// moving between different arenas moves the elements, not the buffer
+		heap_copy = std::move(arena_copy);
+		assert(heap_copy == v && !in_arena(heap_copy.data()));
+		assert(heap_copy.get_allocator().resource() == std::pmr::get_default_resource());
+
+		// moving within the same arena steals the buffer
+		auto* old = v.data();
+		pmr::Vec<int> same(&arena);
+		same = std::move(v);
+		assert(same.data() == old && v.empty());
+
+		// nested pmr::Vecs hand their arena down to their elements
+		pmr::Vec<pmr::Vec<int>> nested(&arena);
+		nested.emplace_back(size_t{3}, 7);
+		assert(nested.front() == (pmr::Vec<int>{7, 7, 7}));
+		assert(nested.front().get_allocator().resource() == &arena);
+		assert(in_arena(nested.front().data()));
+
+		same.clear();
+		assert(same.empty() && same.get_allocator().resource() == &arena);
+		// the arena is released all at once, when it goes out of scope
+	}
+
+	// 16) SmallVec keeps small contents inline, and spills to the heap beyond N
+	{
+		static_assert(std::regular<SmallVec<int, 4>>);
+
+		SmallVec<int, 4> s{1, 2, 3};
+		assert(s.is_inline() && s.capacity() == 4);
+		assert(static_cast<const void*>(s.data()) >= static_cast<const void*>(&s)
+			&& static_cast<const void*>(s.data()) < static_cast<const void*>(&s + 1));
+		s.push_back(4);
+		assert(s.is_inline());
+		s.push_back(5); // spills
+		assert(!s.is_inline() && s.capacity() == 8);
+		assert(s == (SmallVec<int, 4>{1, 2, 3, 4, 5}));
+		assert(s.at(4) == 5);
+
+		// moving a heap SmallVec steals the buffer...
+		const auto* heap = s.data();
+		SmallVec<int, 4> moved = std::move(s);
+		assert(moved.data() == heap && s.empty() && s.is_inline());
+
+		// ... moving an inline one moves the elements into the new object
+		SmallVec<int, 4> small{3, 1, 2};
+		SmallVec<int, 4> moved_small = std::move(small);
+		assert(moved_small.is_inline() && moved_small.data() != small.data());
+		assert(moved_small == (SmallVec<int, 4>{3, 1, 2}) && small.empty());
+
+		std::sort(moved_small.begin(), moved_small.end());
+		assert(moved_small == (SmallVec<int, 4>{1, 2, 3}));
+		assert(moved_small < moved);
+
+		swap(moved_small, moved); // inline <-> heap
+		assert(moved_small.size() == 5 && !moved_small.is_inline());
+		assert(moved.size() == 3 && moved.is_inline());
+
+		moved_small.shrink_to_fit();
+		assert(moved_small.capacity() == 5);
+		moved_small.clear();
+		assert(moved_small.is_inline() && moved_small.capacity() == 4);
+
+		// move-only elements, inline and spilled, with no leaks
+		SmallVec<std::unique_ptr<int>, 2> owners;
+		owners.push_back(std::make_unique<int>(1));
+		SmallVec<std::unique_ptr<int>, 2> inline_owners = std::move(owners);
+		assert(*inline_owners.front() == 1 && owners.empty());
+		inline_owners.push_back(std::make_unique<int>(2));
+		inline_owners.push_back(std::make_unique<int>(3));
+		assert(!inline_owners.is_inline() && *inline_owners.back() == 3);
+
+		const int live_before = Tracked::live;
+		{
+			SmallVec<Tracked, 2> t(3, Tracked{1});
+			SmallVec<Tracked, 2> u = t;
+			t.shrink_to_fit();
+			u = SmallVec<Tracked, 2>{Tracked{2}};
+			swap(t, u);
+			assert(t.size() == 1 && u.size() == 3);
+		}
+		assert(Tracked::live == live_before);
+	}
+
+	// 17) operator== takes the memcmp path for bytewise comparable types only
+	{
+		static_assert(detail::bytewise_equality_comparable<int>);
+		static_assert(detail::bytewise_equality_comparable<std::byte>);
+		static_assert(!detail::bytewise_equality_comparable<float>);
+		static_assert(!detail::bytewise_equality_comparable<Tracked>);
+
+		Vec<int> a(100'000, 1);
+		Vec<int> b = a;
+		assert(a == b);
+		b.back() = 2; // the only difference is in the very last element
+		assert(!(a == b));
+
+		Vec<std::byte> bytes(4096, std::byte{0xAB});
+		Vec<std::byte> other(4096, std::byte{0xAB});
+		assert(bytes == other);
+		other.front() = std::byte{0};
+		assert(bytes != other);
+
+		assert(Vec<int>{} == Vec<int>{});
+
+		// floats keep their value semantics, even though their bytes differ
+		assert((Vec<double>{0.0}) == (Vec<double>{-0.0}));
+		const double nan = std::numeric_limits<double>::quiet_NaN();
+		assert(!((Vec<double>{nan}) == (Vec<double>{nan})));
+	}
+
+	// 18) operator<=> agrees with std::lexicographical_compare_three_way, fast path or not
+	{
+		static_assert(detail::bytewise_orderable<std::uint8_t>);
+		static_assert(!detail::bytewise_orderable<signed char>);
+		static_assert(std::is_same_v<decltype(Vec<double>{} <=> Vec<double>{}),
+			std::partial_ordering>, "ordering category is T's");
+
+		assert((Vec<int>{-1}) < (Vec<int>{1})); // not byte order!
+		assert((Vec<std::uint8_t>{1, 200}) > (Vec<std::uint8_t>{1, 100}));
+		assert((Vec<std::uint8_t>{1, 2}) < (Vec<std::uint8_t>{1, 2, 0}));
+		assert((Vec<std::byte>{}) == (Vec<std::byte>{}));
+
+		// pseudo-random keys that share long prefixes, checked against the reference
+		const auto check = [](const auto& x, const auto& y){
+			const auto expected = std::lexicographical_compare_three_way(
+				x.begin(), x.end(), y.begin(), y.end());
+			return (x <=> y) == expected;
+		};
+		unsigned seed = 12345;
+		const auto next = [&seed]{ seed = seed * 1103515245u + 12345u; return seed >> 16; };
+		for(int round = 0; round < 200; ++round){
+			const size_t len = next() % 1000;
+			Vec<std::uint8_t> bytes(len, std::uint8_t{7});
+			Vec<long long> wide(len, -3);
+			Vec<char> chars(len, 'x');
+			auto bytes2 = bytes;
+			auto wide2 = wide;
+			auto chars2 = chars;
+			if(len && next() % 4 != 0){ // sometimes equal, mostly not
+				const size_t at = next() % len;
+				bytes2[at] = static_cast<std::uint8_t>(next());
+				wide2[at] = static_cast<long long>(next()) - 30000;
+				chars2[at] = static_cast<char>(next());
+			}
+			if(next() % 3 == 0){
+				bytes2.push_back(0);
+				wide2.push_back(0);
+				chars2.push_back(0);
+			}
+			assert(check(bytes, bytes2) && check(bytes2, bytes));
+			assert(check(wide, wide2) && check(wide2, wide));
+			assert(check(chars, chars2) && check(chars2, chars));
+		}
+	}
+
+	// 19) InstrumentedVec counts allocations and element copies/moves, per element type
+	{
+		static_assert(sizeof(InstrumentedVec<int>) == sizeof(Vec<int>));
+		VecStats<long>::reset();
+		{
+			InstrumentedVec<long> v;
+			for(long i = 0; i < 100; ++i){
+				v.push_back(long{i}); // push_back(rvalue) is a move
+			}
+			const auto grown = VecStats<long>::snapshot();
+			assert(grown.allocations == 8); // capacities 1, 2, 4, ... 128
+			assert(grown.deallocations == 7);
+			assert(grown.bytes_live == v.capacity() * sizeof(long));
+			// the peak is during the last growth, when the old and the new buffer both exist
+			assert(grown.peak_bytes == (128 + 64) * sizeof(long));
+			assert(grown.copy_constructions == 0);
+			assert(grown.move_constructions == 100 + 127); // the pushes + relocations
+
+			InstrumentedVec<long> copy = v;
+			InstrumentedVec<long> moved = std::move(copy); // moving the Vec moves no elements
+			const auto copied = VecStats<long>::snapshot();
+			assert(copied.allocations == 9);
+			assert(copied.copy_constructions == 100);
+			assert(copied.move_constructions == grown.move_constructions);
+			assert(moved == v);
+		}
+		const auto after = VecStats<long>::snapshot();
+		assert(after.bytes_live == 0 && after.allocations == after.deallocations);
+
+		// stats are per element type
+		assert(VecStats<double>::snapshot().allocations == 0);
+	}
+
+	// 20) MappedVec maps a file and looks just like a Vec
+	{
+		const auto path = std::filesystem::temp_directory_path() / "raii_2025_mapped.i32";
+		{
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			for(int i = 0; i < 1000; ++i){
+				file.write(reinterpret_cast<const char*>(&i), sizeof(i));
+			}
+		}
+		{
+			MappedVec<const int> column(path);
+			assert(column.size() == 1000);
+			assert(column.front() == 0 && column.back() == 999 && column.at(500) == 500);
+			assert(std::accumulate(column.begin(), column.end(), 0) == 999 * 1000 / 2);
+			MappedVec<const int> moved = std::move(column);
+			assert(column.empty() && column.data() == nullptr && moved.size() == 1000);
+		}
+		{
+			auto out = MappedVec<int>::create(path, 3);
+			assert(out.size() == 3 && out[0] == 0 && out[2] == 0); // fresh files read as zeroes
+			out[0] = 7;
+			out.back() = 9;
+			out.flush();
+		}
+		{
+			const MappedVec<const int> reread(path);
+			const MappedVec<const int> again(path);
+			assert(reread.size() == 3 && reread[0] == 7 && reread[1] == 0 && reread[2] == 9);
+			assert(reread == again);
+		}
+		{
+			auto empty = MappedVec<int>::create(path, 0);
+			assert(empty.empty() && empty.begin() == empty.end());
+		}
+		{
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file.write("abcde", 5); // not a whole number of ints
+		}
+		bool threw = false;
+		try{
+			MappedVec<const int> broken(path);
+		} catch(const std::runtime_error&){
+			threw = true;
+		}
+		assert(threw);
+		threw = false;
+		try{
+			MappedVec<const int> missing(path.string() + ".does-not-exist");
+		} catch(const std::system_error&){
+			threw = true;
+		}
+		assert(threw);
+		// a size whose byte count doesn't fit is refused before the file is touched
+		threw = false;
+		try{
+			auto huge = MappedVec<int>::create(path, std::numeric_limits<size_t>::max() / 2);
+		} catch(const std::length_error&){
+			threw = true;
+		}
+		assert(threw && std::filesystem::file_size(path) == 5);
+		std::filesystem::remove(path);
+	}
+
+	// 21) binary round trip through a file descriptor, and a zero-copy view of the file
+	{
+		const auto path = std::filesystem::temp_directory_path() / "raii_2025_vec.bin";
+		Vec<double> original;
+		for(int i = 0; i < 10'000; ++i){
+			original.push_back(i * 0.5);
+		}
+		const int fd = open_for_test(path);
+		assert(fd >= 0);
+		write_to(fd, original);
+		write_to(fd, Vec<double>{}); // an empty one right behind it
+		using SlowGrowth = Vec<int, std::allocator<int>, std::ratio<3, 2>>;
+		write_to(fd, SlowGrowth{1, 2, 3}); // and one that grows by its own factor
+		rewind_for_test(fd);
+		const auto loaded = read_from<double>(fd);
+		const auto loaded_empty = read_from<double>(fd);
+		const SlowGrowth loaded_slow = read_from<int, std::allocator<int>, std::ratio<3, 2>>(fd);
+		close_for_test(fd);
+		assert(loaded == original && loaded_empty.empty());
+		assert((loaded_slow == SlowGrowth{1, 2, 3}));
+		const auto expected_bytes =
+			3 * sizeof(VecFileHeader) + 10'000 * sizeof(double) + 3 * sizeof(int);
+		assert(std::filesystem::file_size(path) == expected_bytes);
+
+		// map the file, and look at the first Vec in it without copying a single element
+		const MappedVec<const std::byte> file(path);
+		const std::span<const std::byte> bytes(file.data(), file.size());
+		const auto view = view_from<double>(bytes);
+		assert(view.size() == original.size());
+		assert(static_cast<const void*>(view.data()) == file.data() + sizeof(VecFileHeader));
+		assert(std::ranges::equal(view, original));
+
+		// the header protects us from misreading the bytes
+		const auto throws = [&](auto load){
+			try{
+				load();
+			} catch(const std::runtime_error&){
+				return true;
+			}
+			return false;
+		};
+		assert(throws([&]{ view_from<float>(bytes); }));				// wrong element type
+		assert(throws([&]{ view_from<double>(bytes.subspan(8)); }));	// not a header
+		assert(throws([&]{ view_from<double>(bytes.first(100)); }));	// truncated
+		Vec<std::byte> shifted(bytes.size() + 1);
+		std::memcpy(shifted.data() + 1, bytes.data(), bytes.size());
+		assert(throws([&]{
+			view_from<double>(std::span<const std::byte>(shifted.data() + 1, bytes.size()));
+		})); // misaligned
+		std::filesystem::remove(path);
+	}
+
+	// 22) VecView: non-owning slices of a Vec, that convert to and from std::span
+	{
+		Vec<int> v{0, 1, 2, 3, 4, 5, 6, 7};
+		static_assert(sizeof(VecView<int>) == sizeof(int*) + sizeof(size_t));
+		static_assert(std::ranges::contiguous_range<VecView<int>>);
+		static_assert(std::ranges::view<VecView<int>>);
+		static_assert(std::ranges::borrowed_range<VecView<const int>>);
+		static_assert(std::is_convertible_v<VecView<int>, VecView<const int>>);
+		static_assert(!std::is_convertible_v<VecView<const int>, VecView<int>>);
+		static_assert(!std::is_convertible_v<const Vec<int>&, VecView<int>>);
+		static_assert(!std::is_convertible_v<Vec<int>&&, VecView<const int>>); // would dangle
+
+		// a Vec converts implicitly, so functions can take a VecView and not care who owns what
+		const auto sum = [](VecView<const int> view){
+			return std::accumulate(view.begin(), view.end(), 0);
+		};
+		assert(sum(v) == 28);
+		const Vec<int>& cv = v;
+		assert(sum(cv) == 28);
+
+		// slicing never copies, the views look at v's own elements
+		VecView<int> all = v;
+		assert(all.data() == v.data() && all.size() == v.size());
+		const auto middle = all.subview(2, 4);
+		assert(middle.size() == 4 && middle.data() == v.data() + 2);
+		assert(middle.front() == 2 && middle.back() == 5);
+		assert(middle.first(2).back() == 3);
+		assert(middle.last(1).front() == 5);
+		assert(all.subview(6).size() == 2 && all.subview(8).empty());
+		assert(sum(middle) == 14);
+		assert(sum(all.first(0)) == 0);
+
+		// writes go straight through to the Vec
+		for(int& x : all.last(2)){
+			x *= 10;
+		}
+		assert(v[6] == 60 && v[7] == 70);
+		middle[0] = -2;
+		assert(v[2] == -2);
+
+		// to and from std::span, both ways
+		std::span<int> s = middle;
+		assert(s.data() == middle.data() && s.size() == middle.size());
+		const VecView<const int> back_from_span = std::span<const int>(s);
+		assert(back_from_span == middle);
+
+		// views compare by contents, like Vecs do
+		const Vec<int> copy(middle.begin(), middle.end());
+		assert(VecView(copy) == middle);
+		assert(VecView(copy).first(2) < VecView<const int>(middle));
+		assert(all.first(3) != all.last(3));
+
+		// anything contiguous will do
+		SmallVec<int, 4> small{1, 2, 3};
+		assert(sum(small) == 6);
+		const std::vector<int> vector{4, 5};
+		assert(sum(vector) == 9);
+
+		bool threw = false;
+		try{
+			(void)middle.at(4);
+		} catch(const std::out_of_range&){
+			threw = true;
+		}
+		assert(threw);
+	}
+
+	// 23) iterators: checked in debug builds, plain pointers in release builds
+	{
+		using It = Vec<int>::iterator;
+		using CIt = Vec<int>::const_iterator;
+		static_assert(std::contiguous_iterator<It> && std::contiguous_iterator<CIt>);
+		static_assert(std::is_convertible_v<It, CIt> && !std::is_convertible_v<CIt, It>);
+		static_assert(std::ranges::contiguous_range<Vec<int>>);
+		static_assert(VEC_CHECKED_ITERATORS || std::is_same_v<It, int*>);
+
+		Vec<int> v{5, 3, 1, 4, 2};
+		v.reserve(8);
+		It first = v.begin();
+		CIt last = v.end();
+		assert(first != last && last - first == 5);
+		assert(std::to_address(first) == v.data() && std::to_address(last) == v.data() + 5);
+		assert(first[2] == 1 && *(first + 4) == 2 && *--v.end() == 2);
+
+		std::sort(v.begin(), v.end());
+		std::ranges::sort(v, std::greater{});
+		assert(std::ranges::equal(v, std::initializer_list<int>{5, 4, 3, 2, 1}));
+
+		// appending within capacity doesn't reallocate, so 'first' stays valid
+		v.push_back(0);
+		assert(*first == 5 && first + 6 == v.end());
+
+		// value-initialized iterators are all equal, like null pointers
+		assert(It{} == It{} && It{} - It{} == 0);
+
+		// with checked iterators, dereferencing an iterator the Vec has invalidated asserts.
+		// (We can't watch an assert fire from in here, so we ask the iterator instead.)
+#if VEC_CHECKED_ITERATORS
+		while(v.size() < v.capacity()){
+			v.push_back(6);
+		}
+		assert(first.valid() && last.valid() && !It{}.valid());
+		v.push_back(6); // full: reallocates
+		assert(!first.valid() && !last.valid());
+
+		first = v.begin();
+		v.insert(v.begin() + 1, 9);
+		assert(!first.valid());
+		first = v.begin();
+		v.erase(v.begin());
+		assert(!first.valid());
+
+		first = v.begin();
+		Vec<int> other{7};
+		It other_first = other.begin();
+		v.swap(other);
+		assert(!first.valid() && !other_first.valid());
+
+		first = v.begin();
+		const Vec<int> moved = std::move(v);
+		assert(!first.valid());
+
+		first = other.begin();
+		other.clear();
+		assert(!first.valid() && other.begin().valid());
+
+		// where checked iterators are stricter than the standard: they point at the Vec, so
+		// when the Vec itself moves they have to be taken again, buffer or no buffer
+		Vec<Vec<int>> rows;
+		rows.reserve(2);
+		rows.emplace_back(Vec<int>{1, 2, 3});
+		It inner = rows[0].begin();
+		rows.emplace_back(Vec<int>{4}); // within capacity: rows[0] stays where it is
+		assert(inner.valid() && *inner == 1);
+		const int* buffer = rows[0].data();
+		rows.emplace_back(Vec<int>{5}); // rows reallocates: rows[0] moves, its buffer doesn't
+		assert(rows[0].data() == buffer);
+		// a plain pointer would still be good here. 'inner' points at the destroyed rows[0],
+		// so don't touch it: take it again.
+		inner = rows[0].begin();
+		assert(inner.valid() && *inner == 1);
+#endif
+	}
+
+	// 24) parallel fill, copy and compare, through the standard execution policies
+	{
+		const size_t big = parallel_threshold<int> + 1000;
+		const Vec<int> filled = parallel_fill(std::execution::par_unseq, big, 7);
+		assert(filled.size() == big && filled.front() == 7 && filled.back() == 7);
+		assert(std::ranges::count(filled, 7) == static_cast<std::ptrdiff_t>(big));
+
+		Vec<int> copy = parallel_copy(std::execution::par, filled);
+		assert(copy.size() == big && copy.data() != filled.data());
+		assert(parallel_equal(std::execution::par, copy, filled) && copy == filled);
+		copy[big / 2] = 8;
+		assert(!parallel_equal(std::execution::par, copy, filled));
+		assert(!parallel_equal(std::execution::par, copy, Vec<int>(big - 1, 7)));
+
+		// below the threshold it is the serial code, and the same results
+		const Vec<int> small = parallel_fill(std::execution::par, 10, 3);
+		const Vec<int> small_copy = parallel_copy(std::execution::seq, small);
+		assert(small_copy == Vec<int>(10, 3));
+		assert(parallel_equal(std::execution::par, small_copy, small));
+
+		// not just for trivial types
+		const size_t many = parallel_threshold<std::string> + 1;
+		const Vec<std::string> words =
+			parallel_fill(std::execution::par, many, std::string(40, 'x'));
+		const Vec<std::string> words_copy = parallel_copy(std::execution::par, words);
+		assert(parallel_equal(std::execution::par, words_copy, words));
+		assert(words_copy.back().size() == 40);
+
+		// allocators with their own construct() get the serial loop, so every copy is counted
+		VecStats<long>::reset();
+		const InstrumentedVec<long> counted =
+			parallel_fill(std::execution::par, 1000, 5L, InstrumentedAllocator<long>());
+		assert(VecStats<long>::snapshot().copy_constructions == 1000);
+	}
+
+	// 25) PageAllocator: cache-line and page alignment, huge pages and NUMA hints, per Vec
+	{
+		const auto aligned_to = [](const void* p, size_t alignment){
+			return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+		};
+
+		// the default policy is just operator new
+		PageVec<int> plain;
+		for(int i = 0; i < 1000; ++i){
+			plain.push_back(i);
+		}
+		assert(plain.size() == 1000 && plain.back() == 999);
+
+		PageVec<char> line(PageAllocator<char>({.alignment = 64}));
+		line.push_back('a');
+		assert(aligned_to(line.data(), 64));
+
+		PageVec<double> page(1000, 1.5, PageAllocator<double>({.alignment = 4096}));
+		assert(aligned_to(page.data(), 4096) && page.back() == 1.5);
+
+		// huge pages, interleaved over node 0 (the one node every machine has)
+		const MemoryPolicy big{.huge_pages = true, .numa = MemoryPolicy::Numa::interleave,
+			.numa_nodes = 0b1};
+		PageVec<std::uint64_t> huge(std::uint64_t{1} << 18, PageAllocator<std::uint64_t>(big));
+		assert(huge.get_allocator().policy() == big);
+#if !defined(_WIN32)
+		assert(aligned_to(huge.data(), size_t{2} << 20));
+#endif
+		for(size_t i = 0; i < huge.size(); ++i){
+			huge[i] = i;
+		}
+		huge.push_back(42); // grows into fresh huge pages, under the same policy
+		assert(huge.back() == 42 && huge[12345] == 12345);
+
+		// the policy follows the elements around
+		const PageVec<std::uint64_t> copy = huge;
+		assert(copy == huge && copy.get_allocator() == huge.get_allocator());
+		plain = PageVec<int>(10, 7, PageAllocator<int>({.alignment = 4096}));
+		assert(aligned_to(plain.data(), 4096) && plain.get_allocator().policy().alignment == 4096);
+		assert(plain.get_allocator() != PageAllocator<int>());
+	}
+
+	// 26) AlignedVec: over-aligned storage, with the alignment known at compile time
+	{
+		static_assert(Vec<float>::alignment == alignof(float));
+		static_assert(AlignedVec<float>::alignment == 64);
+		static_assert(AlignedVec<float, 32>::alignment == 32);
+		// wrapping the allocator keeps its promise
+		using Counted = InstrumentedAllocator<float, AlignedAllocator<float, 64>>;
+		static_assert(Vec<float, Counted>::alignment == 64);
+		const auto aligned_to = [](const void* p, size_t alignment){
+			return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+		};
+
+		AlignedVec<float> samples;
+		assert(samples.data() == nullptr);
+		for(int i = 0; i < 100; ++i){
+			samples.push_back(static_cast<float>(i));
+			assert(aligned_to(samples.data(), 64)); // after every reallocation
+		}
+		samples.shrink_to_fit();
+		assert(aligned_to(samples.data(), 64) && samples.back() == 99.0f);
+
+		const AlignedVec<float> copy = samples;
+		assert(copy == samples && aligned_to(copy.data(), 64));
+
+		const AlignedVec<char, 4096> page(10, 'x');
+		assert(aligned_to(page.data(), 4096) && page.front() == 'x');
+	}
+
+	// 27) SoaVec: rows stored as one column per field, in a single allocation
+	{
+		using Particles = SoaVec<int, float, std::string>; // id, mass, name
+		using Row = Particles::value_type;
+		static_assert(std::random_access_iterator<Particles::iterator>);
+		static_assert(std::random_access_iterator<Particles::const_iterator>);
+		static_assert(std::sortable<Particles::iterator>);
+		static_assert(std::ranges::random_access_range<Particles>);
+		static_assert(std::is_convertible_v<Particles::iterator, Particles::const_iterator>);
+
+		Particles particles{{3, 1.5f, "c"}, {1, 0.5f, "a"}};
+		particles.emplace_back(2, 2.5f, "b");
+		particles.push_back({0, 4.0f, "z"});
+		assert(particles.size() == 4);
+
+		// each column is contiguous, aligned, and they all live in one buffer
+		const std::span<float> masses = particles.column<1>();
+		assert(masses.size() == 4 && masses[2] == 2.5f);
+		assert(std::accumulate(masses.begin(), masses.end(), 0.0f) == 8.5f);
+		assert(reinterpret_cast<std::uintptr_t>(masses.data()) % 64 == 0);
+		const auto* ids_begin = static_cast<const void*>(particles.column<0>().data());
+		assert(static_cast<const void*>(masses.data()) > ids_begin);
+		assert(static_cast<const void*>(particles.column<2>().data()) > masses.data());
+
+		// rows are proxies: reading, writing, and structured bindings go to the columns
+		auto [id, mass, name] = particles[1];
+		mass = 0.75f;
+		assert(particles.column<1>()[1] == 0.75f && id == 1 && name == "a");
+		particles[0] = particles[3];
+		assert(particles[0] == Row(0, 4.0f, "z"));
+		particles[0] = {3, 1.5f, "c"};
+		const Row copied = particles[0];
+		assert(std::get<2>(copied) == "c");
+
+		// std::sort moves whole rows, by the tuple order or by any field we like
+		std::sort(particles.begin(), particles.end());
+		assert((std::ranges::equal(particles.column<0>(), std::array{0, 1, 2, 3})));
+		assert((std::ranges::equal(particles.column<2>(), std::array{"z", "a", "b", "c"})));
+		std::ranges::sort(particles, std::greater{}, [](const auto& row){ return get<1>(row); });
+		assert((std::ranges::equal(particles.column<1>(), std::array{4.0f, 2.5f, 1.5f, 0.75f})));
+		assert(particles.front().get<2>() == "z");
+
+		// the algorithms that move ask iter_move, which moves whole rows out: so move-only
+		// fields sort too, and nothing is copied along the way
+		using Owned = SoaVec<int, std::unique_ptr<int>>;
+		static_assert(std::sortable<Owned::iterator>);
+		static_assert(std::permutable<Owned::iterator>);
+		Owned owned;
+		for(int i : {3, 1, 4, 0, 2}){
+			owned.emplace_back(i, std::make_unique<int>(i * 10));
+		}
+		Owned::value_type moved = iter_move(owned.begin());
+		assert(std::get<0>(moved) == 3 && *std::get<1>(moved) == 30 && !owned[0].get<1>());
+		owned[0] = iter_move(owned.begin() + 3);
+		assert(owned[0].get<0>() == 0 && *owned[0].get<1>() == 0 && !owned[3].get<1>());
+		owned[3] = std::move(moved);
+		std::ranges::iter_swap(owned.begin(), owned.begin() + 3);
+		assert(*owned[0].get<1>() == 30 && *owned[3].get<1>() == 0);
+#if defined(_MSVC_STL_VERSION) || defined(_LIBCPP_VERSION)
+		// (libstdc++'s ranges::sort hands the work to std::sort, which moves with
+		// std::move(*it): a copy, for a proxy. Its sortable check still passes, above.)
+		std::ranges::sort(owned);
+		assert((std::ranges::equal(owned.column<0>(), std::array{0, 1, 2, 3, 4})));
+		for(const auto [id, ptr] : owned){
+			assert(*ptr == id * 10);
+		}
+#endif
+
+		int sum = 0;
+		for(const auto row : particles){
+			sum += row.get<0>();
+		}
+		assert(sum == 6);
+
+		// growing keeps every row, copies are deep, and compare column by column
+		for(int i = 0; i < 100; ++i){
+			particles.emplace_back(i, 1.0f, std::to_string(i));
+		}
+		assert(particles.size() == 104 && particles.back().get<2>() == "99");
+		assert(reinterpret_cast<std::uintptr_t>(particles.column<2>().data()) % 64 == 0);
+		Particles copy = particles;
+		assert(copy == particles);
+		copy[50].get<1>() = -1.0f;
+		assert(copy != particles);
+
+		// a throwing copy leaves nothing behind: the finished columns are destroyed again
+		SoaVec<int, Tracked> tracked;
+		for(int i = 0; i < 10; ++i){
+			tracked.emplace_back(i, Tracked(i));
+		}
+		const int live = Tracked::live;
+		Tracked::reset();
+		Tracked::throw_countdown = 5;
+		bool threw = false;
+		try{
+			SoaVec<int, Tracked> failed = tracked;
+		} catch(const std::runtime_error&){
+			threw = true;
+		}
+		assert(threw && Tracked::live == live);
+		Tracked::reset();
+
+		// growth that throws keeps the strong guarantee for the whole row: when one field
+		// has to be copied, all of them are, so the strings aren't moved out and lost
+		SoaVec<std::string, Tracked> named;
+		for(int i = 0; i < 4; ++i){
+			named.emplace_back(std::string(32, char('a' + i)), Tracked(i));
+		}
+		Tracked::throw_countdown = 2;
+		threw = false;
+		try{
+			named.reserve(100);
+		} catch(const std::runtime_error&){
+			threw = true;
+		}
+		assert(threw && named.capacity() == 4);
+		assert(named.column<0>()[0] == std::string(32, 'a'));
+		assert(named.column<0>()[3] == std::string(32, 'd'));
+		Tracked::throw_countdown = 3;
+		threw = false;
+		try{
+			named.emplace_back("e", Tracked(4));
+		} catch(const std::runtime_error&){
+			threw = true;
+		}
+		assert(threw && named.size() == 4 && named.column<0>()[1] == std::string(32, 'b'));
+		Tracked::reset();
+
+		copy.clear();
+		assert(copy.empty() && copy.capacity() == 0);
+	}
+
+	// 28) ConcurrentVec: many threads appending at once, no locks, nothing ever moves
+	{
+		ConcurrentVec<long> results;
+		const long& first = results.push_back(-1);
+		constexpr int producers = 4;
+		constexpr long per_producer = 20000;
+		{
+			std::vector<std::jthread> threads;
+			for(int t = 0; t < producers; ++t){
+				threads.emplace_back([&results, t]{
+					for(long i = 0; i < per_producer; ++i){
+						results.push_back(t * per_producer + i);
+					}
+				});
+			}
+			// reading while they write: a snapshot is frozen, whatever happens next
+			const auto early = results.snapshot();
+			const size_t early_size = early.size();
+			assert(early_size >= 1 && early[0] == -1);
+			long early_sum = 0;
+			early.for_each_segment([&](VecView<const long> segment){
+				early_sum += std::accumulate(segment.begin(), segment.end(), 0L);
+			});
+			assert(early.size() == early_size && early_sum >= -1);
+		} // joins
+
+		// every value made it in exactly once, and the first element never moved
+		constexpr long total = producers * per_producer;
+		assert(results.size() == total + 1);
+		assert(&first == &results[0] && first == -1);
+		const auto all = results.snapshot();
+		assert(std::accumulate(all.begin(), all.end(), 0L) == total * (total - 1) / 2 - 1);
+		Vec<long> sorted = all.to_vec();
+		std::sort(sorted.begin(), sorted.end());
+		for(long i = 0; i < total; ++i){
+			assert(sorted[static_cast<size_t>(i + 1)] == i);
+		}
+
+		// segments cover the snapshot in order, with no gaps
+		size_t covered = 0;
+		all.for_each_segment([&](VecView<const long> segment){
+			assert(segment.data() == &all[covered]);
+			covered += segment.size();
+		});
+		assert(covered == all.size());
+
+		// many readers at once, on elements too big to be written in one go: a reader that
+		// only learns the size from another reader's scan must still see finished elements.
+		// (Build with -fsanitize=thread to have this checked for data races, too.)
+		struct Big{
+			explicit Big(long v) noexcept{
+				std::ranges::fill(values, v);
+			}
+			std::array<long, 16> values;
+		};
+		ConcurrentVec<Big> bigs;
+		{
+			std::atomic<bool> done{false};
+			std::vector<std::jthread> threads;
+			for(int r = 0; r < 3; ++r){
+				threads.emplace_back([&bigs, &done]{
+					while(!done.load(std::memory_order_relaxed)){
+						const auto seen = bigs.snapshot();
+						seen.for_each_segment([](VecView<const Big> segment){
+							for(const Big& big : segment){
+								assert(std::ranges::count(big.values, big.values[0]) == 16);
+							}
+						});
+						if(const size_t count = bigs.size()){
+							const Big& last = bigs[count - 1];
+							assert(std::ranges::count(last.values, last.values[0]) == 16);
+						}
+					}
+				});
+			}
+			{
+				std::vector<std::jthread> writers;
+				for(int t = 0; t < producers; ++t){
+					writers.emplace_back([&bigs, t]{
+						for(long i = 0; i < 5000; ++i){
+							bigs.emplace_back(t * 5000 + i);
+						}
+					});
+				}
+			} // joins the writers
+			done = true;
+		} // and the readers
+		assert(bigs.size() == producers * 5000);
+
+		// elements are destroyed with the ConcurrentVec
+		Tracked::reset();
+		const int live = Tracked::live;
+		{
+			ConcurrentVec<Tracked> tracked;
+			for(int i = 0; i < 1000; ++i){
+				tracked.emplace_back(i);
+			}
+			assert(Tracked::live == live + 1000 && tracked[999].value == 999);
+		}
+		assert(Tracked::live == live);
+	}
+
+	// 29) CowVec: copies share one buffer until one of them writes
+	{
+		using Stats = CowVecStats<int>;
+		Stats::reset();
+		const CowVec<int> original{1, 2, 3, 4};
+
+		// copying only bumps the reference count
+		CowVec<int> copy = original;
+		assert(std::as_const(copy).data() == original.data() && original.use_count() == 2);
+		assert(Stats::snapshot().shares == 1 && Stats::snapshot().detaches == 0);
+
+		// reading never detaches, not even through a non-const copy, as long as it says so
+		assert(std::as_const(copy)[2] == 3 && copy.view().back() == 4 && copy == original);
+		assert(*copy.cbegin() == 1 && copy.size() == 4);
+		assert(std::as_const(copy).data() == original.data());
+		assert(Stats::snapshot().detaches == 0);
+
+		// the first write copies, and only the writer sees it
+		copy[0] = 10;
+		assert(std::as_const(copy).data() != original.data() && original.use_count() == 1);
+		assert(copy[0] == 10 && original[0] == 1 && copy != original && original < copy);
+		assert(Stats::snapshot().detaches == 1);
+		assert(Stats::snapshot().bytes_detached == 4 * sizeof(int));
+
+		// 'copy' handed out a writable reference: its copies are deep, or they'd see this
+		int& first = copy.front();
+		const CowVec<int> frozen = copy;
+		first = 20;
+		assert(frozen[0] == 10 && copy[0] == 20 && frozen.use_count() == 1);
+		assert(Stats::snapshot().deep_copies == 1 && Stats::snapshot().shares == 1);
+
+		// push_back detaches too, but leaves the buffer shareable
+		CowVec<int> grown = original;
+		grown.push_back(5);
+		assert(grown.size() == 5 && original.size() == 4 && Stats::snapshot().detaches == 2);
+		const CowVec<int> again = grown;
+		assert(again.data() == std::as_const(grown).data() && Stats::snapshot().shares == 3);
+
+		// an empty CowVec has no buffer at all; writing to it starts one
+		CowVec<int> empty;
+		assert(empty.empty() && empty.use_count() == 0 && empty.cbegin() == empty.cend());
+		empty.push_back(1);
+		assert(empty.size() == 1 && empty.use_count() == 1);
+		empty.clear();
+		assert(empty.empty() && empty.use_count() == 0);
+
+		// copies go to other threads; the last one out frees the buffer
+		Tracked::reset();
+		const int live = Tracked::live;
+		{
+			CowVec<Tracked> table(Vec<Tracked>(100, Tracked(7)));
+			Vec<int> sums(8, 0);
+			{
+				Vec<std::jthread> readers;
+				for(size_t t = 0; t < sums.size(); ++t){
+					readers.emplace_back([mine = table, &sum = sums[t]]{
+						for(const Tracked& element : mine){
+							sum += element.value;
+						}
+					});
+				}
+			}
+			assert(std::all_of(sums.begin(), sums.end(), [](int sum){ return sum == 700; }));
+			assert(table.use_count() == 1 && Tracked::live == live + 100);
+		}
+		assert(Tracked::live == live);
+	}
+
+	// 30) growing trivially relocatable elements by moving bytes, or pages
+	{
+		static_assert(is_trivially_relocatable_v<int> && is_trivially_relocatable_v<Message>);
+		static_assert(!is_trivially_relocatable_v<Tracked> && is_trivially_relocatable_v<Owner>);
+
+		// Owner is relocated with memcpy: nobody is moved, nobody is destroyed along the way
+		{
+			Vec<Owner> owners;
+			for(int i = 0; i < 1000; ++i){
+				owners.emplace_back(i);
+			}
+			assert(Owner::live == 1000);
+			owners.shrink_to_fit();
+			assert(owners.capacity() == 1000 && Owner::live == 1000);
+			for(int i = 0; i < 1000; ++i){
+				assert(*owners[static_cast<size_t>(i)].value == i);
+			}
+		}
+		assert(Owner::live == 0);
+
+		// ReallocVec grows through realloc, which may free the old buffer: appending an
+		// element of the Vec itself must still work
+		ReallocVec<int> numbers;
+		numbers.push_back(-1);
+		for(int i = 0; i < 100000; ++i){
+			numbers.push_back(numbers[0]);
+			numbers.back() = i;
+		}
+		assert(numbers.size() == 100001 && numbers.front() == -1 && numbers.back() == 99999);
+		for(size_t i = 1; i < numbers.size(); ++i){
+			assert(numbers[i] == static_cast<int>(i - 1));
+		}
+		numbers.reserve(1 << 20);
+		assert(numbers.capacity() == 1 << 20 && numbers[50000] == 49999);
+		numbers.shrink_to_fit();
+		assert(numbers.capacity() == numbers.size() && numbers.back() == 99999);
+		const ReallocVec<int> copy = numbers;
+		assert(copy == numbers);
+
+		{
+			ReallocVec<Owner> owners;
+			for(int i = 0; i < 1000; ++i){
+				owners.emplace_back(i);
+			}
+			assert(Owner::live == 1000 && *owners[999].value == 999 && *owners[0].value == 0);
+		}
+		assert(Owner::live == 0);
+
+		// Tracked isn't trivially relocatable: ReallocVec quietly copies it the usual way
+		{
+			Tracked::reset();
+			const int live = Tracked::live;
+			ReallocVec<Tracked> tracked;
+			for(int i = 0; i < 100; ++i){
+				tracked.emplace_back(i);
+			}
+			assert(Tracked::copy_ctors > 0 && Tracked::live == live + 100);
+			assert(tracked[0].value == 0 && tracked[99].value == 99);
+		}
+
+		// PageAllocator grows page-aligned mappings with mremap (on Linux, elsewhere it copies)
+		PageVec<std::uint64_t> pages(PageAllocator<std::uint64_t>({.alignment = 4096}));
+		for(std::uint64_t i = 0; i < 100000; ++i){
+			pages.push_back(i);
+		}
+		assert(reinterpret_cast<std::uintptr_t>(pages.data()) % 4096 == 0);
+		for(size_t i = 0; i < pages.size(); ++i){
+			assert(pages[i] == i);
+		}
+	}
+
+	// 31) insert, emplace, erase, erase_if, append_range, assign, resize, pop_back
+	{
+		Vec<int> v{1, 2, 3};
+		v.reserve(16);
+		assert(*v.insert(v.begin() + 1, 10) == 10 && (v == Vec<int>{1, 10, 2, 3}));
+		assert(*v.emplace(v.end(), 4) == 4 && *v.insert(v.begin(), 0) == 0);
+		assert((v == Vec<int>{0, 1, 10, 2, 3, 4}));
+
+		// the inserted value may be one of ours, whether or not the buffer moves
+		v.insert(v.begin(), v.back());
+		v.shrink_to_fit();
+		v.insert(v.begin() + 1, 2, v[0]);
+		assert((v == Vec<int>{4, 4, 4, 0, 1, 10, 2, 3, 4}));
+
+		// ranges go in with a single shift of the tail
+		const std::vector<int> more{7, 8, 9};
+		auto at = v.insert(v.begin() + 3, more.begin(), more.end());
+		assert(at - v.begin() == 3 && (v == Vec<int>{4, 4, 4, 7, 8, 9, 0, 1, 10, 2, 3, 4}));
+		at = v.insert(v.end(), {5, 6});
+		assert(*at == 5 && v.size() == 14 && v.back() == 6);
+		v.insert_range(v.begin(), std::vector<int>{-2, -1});
+		std::istringstream numbers("100 200");
+		v.insert_range(v.begin() + 2, std::views::istream<int>(numbers));
+		assert(v[0] == -2 && v[1] == -1 && v[2] == 100 && v[3] == 200 && v[4] == 4);
+		assert(v.size() == 18 && v.back() == 6);
+
+		// ... and out again
+		at = v.erase(v.begin(), v.begin() + 5);
+		assert(at == v.begin() && v.front() == 4 && v.size() == 13);
+		at = v.erase(v.begin() + 2);
+		assert(*at == 8 && (v == Vec<int>{4, 4, 8, 9, 0, 1, 10, 2, 3, 4, 5, 6}));
+		assert(v.erase(v.end(), v.end()) == v.end() && v.size() == 12);
+		assert(erase(v, 4) == 3 && (v == Vec<int>{8, 9, 0, 1, 10, 2, 3, 5, 6}));
+		assert(erase_if(v, [](int x){ return x % 2 == 0; }) == 5);
+		assert((v == Vec<int>{9, 1, 3, 5}));
+		assert(erase_if(v, [](int x){ return x > 100; }) == 0 && v.size() == 4);
+
+		v.append_range(std::vector<int>{7, 11});
+		std::istringstream odd("13 15");
+		v.append_range(std::views::istream<int>(odd));
+		assert((v == Vec<int>{9, 1, 3, 5, 7, 11, 13, 15}));
+		v.pop_back();
+		v.resize(9);
+		assert(v.size() == 9 && v[6] == 13 && v[7] == 0 && v[8] == 0);
+		v.resize(2);
+		v.resize(4, v[0]);
+		assert((v == Vec<int>{9, 1, 9, 9}));
+
+		// assign reuses the buffer when it can, and the value may be one of ours
+		const int* buffer = v.data();
+		v.assign(3, v[1]);
+		assert((v == Vec<int>{1, 1, 1}) && v.data() == buffer);
+		v.assign({1, 2, 3, 4, 5, 6});
+		assert(v.size() == 6 && v.back() == 6 && v.data() == buffer);
+		v.assign(more.begin(), more.end());
+		assert((v == Vec<int>{7, 8, 9}));
+		v.assign(100, 1);
+		assert(v.size() == 100 && v.capacity() == 100 && v[99] == 1);
+		std::istringstream words("3 2 1");
+		v.assign_range(std::views::istream<int>(words));
+		assert((v == Vec<int>{3, 2, 1}));
+
+		// elements that aren't trivially relocatable are built at the end and rotated in,
+		// without copying anything twice
+		Tracked::reset();
+		const int live = Tracked::live;
+		{
+			Vec<Tracked> tracked;
+			tracked.reserve(8);
+			for(int i = 0; i < 4; ++i){
+				tracked.emplace_back(i);
+			}
+			tracked.emplace(tracked.begin() + 1, 10);
+			tracked.insert(tracked.begin(), tracked[3]);
+			assert(tracked.size() == 6 && Tracked::live == live + 6);
+			assert(tracked[0].value == 2 && tracked[2].value == 10 && tracked[5].value == 3);
+			assert(erase_if(tracked, [](const Tracked& t){ return t.value >= 3; }) == 2);
+			assert(tracked.size() == 4 && Tracked::live == live + 4);
+			tracked.erase(tracked.begin());
+			assert(tracked.front().value == 0 && Tracked::live == live + 3);
+
+			// inserting into a fresh buffer has the strong guarantee: a throwing copy
+			// leaves everything as it was
+			const Vec<Tracked> before = tracked;
+			const Vec<Tracked> many(10, Tracked(7));
+			Tracked::throw_countdown = 5;
+			bool threw = false;
+			try{
+				tracked.insert(tracked.begin() + 1, many.begin(), many.end());
+			} catch(const std::runtime_error&){
+				threw = true;
+			}
+			Tracked::throw_countdown = -1;
+			assert(threw && tracked == before && tracked.capacity() == 8);
+		}
+		assert(Tracked::live == live);
+
+		// Owner is trivially relocatable: the tail is shifted with memmove, and erase_if
+		// moves the survivors as bytes. Nothing is leaked or destroyed twice.
+		{
+			Vec<Owner> owners;
+			for(int i = 0; i < 6; ++i){
+				owners.emplace_back(i);
+			}
+			owners.emplace(owners.begin() + 2, 100);
+			owners.erase(owners.begin());
+			assert(Owner::live == 6 && *owners[1].value == 100 && *owners[2].value == 2);
+			assert(erase_if(owners, [](const Owner& o){ return *o.value % 2 == 1; }) == 3);
+			assert(Owner::live == 3 && owners.size() == 3);
+			assert(*owners[0].value == 100 && *owners[1].value == 2 && *owners[2].value == 4);
+		}
+		assert(Owner::live == 0);
+	}
+
+	// 32) constructing from input iterators and from ranges, read exactly once
+	{
+		// single-pass iterators: the elements stream in, growing geometrically
+		std::istringstream text("1 2 3 4 5 6 7 8 9 10");
+		const Vec<int> streamed(std::istream_iterator<int>(text), std::istream_iterator<int>{});
+		assert(streamed.size() == 10 && streamed.front() == 1 && streamed.back() == 10);
+
+		std::istringstream more("1.5 2.5");
+		const Vec<double> doubles(from_range, std::views::istream<double>(more));
+		assert(doubles.size() == 2 && doubles[1] == 2.5);
+
+		// sized and forward ranges are built in one allocation, of exactly the right size
+		const Vec<int> squares(from_range,
+			std::views::iota(1, 6) | std::views::transform([](int i){ return i * i; }));
+		assert((squares == Vec<int>{1, 4, 9, 16, 25}) && squares.capacity() == 5);
+		const std::forward_list<int> list{5, 6, 7};
+		const Vec<long> longs(from_range, list);
+		assert(longs.size() == 3 && longs.capacity() == 3 && longs[2] == 7);
+		const Vec<int> evens(from_range,
+			streamed | std::views::filter([](int i){ return i % 2 == 0; }));
+		assert((evens == Vec<int>{2, 4, 6, 8, 10}) && evens.capacity() == 5);
+
+		// the element type can be deduced, like std::vector's
+		const Vec deduced(from_range, std::vector<std::string>{"a", "b"});
+		static_assert(std::is_same_v<decltype(deduced), const Vec<std::string>>);
+		assert(deduced.size() == 2 && deduced[1] == "b");
+
+		// a throwing element constructor leaves nothing behind
+		Tracked::reset();
+		const int live = Tracked::live;
+		const Vec<Tracked> source(5, Tracked(1));
+		Tracked::throw_countdown = 3;
+		bool threw = false;
+		try{
+			const Vec<Tracked> copy(from_range, source);
+		} catch(const std::runtime_error&){
+			threw = true;
+		}
+		Tracked::throw_countdown = -1;
+		assert(threw && Tracked::live == live + 5);
+	}
+
+	// 33) resize_and_overwrite: C APIs write straight into the Vec, nothing zeroed first
+	{
+		std::FILE* file = std::tmpfile();
+		assert(file);
+		Vec<std::uint8_t> written(10000);
+		std::iota(written.begin(), written.end(), std::uint8_t{0});
+		assert(std::fwrite(written.data(), 1, written.size(), file) == written.size());
+		std::rewind(file);
+
+		// read it back in 4 KiB chunks, appending to what we have
+		Vec<std::uint8_t> read;
+		for(;;){
+			const size_t had = read.size();
+			read.resize_and_overwrite(had + 4096, [&](std::uint8_t* p, size_t n){
+				return had + std::fread(p + had, 1, n - had, file);
+			});
+			if(read.size() == had){
+				break;
+			}
+		}
+		std::fclose(file);
+		assert(read == written && read.capacity() >= read.size());
+
+		// the elements we had are kept, op decides how many there are in the end
+		Vec<int> v{1, 2, 3};
+		v.resize_and_overwrite(6, [](int* p, size_t n){
+			assert(n == 6 && p[0] == 1 && p[2] == 3);
+			p[3] = 4;
+			p[4] = 5;
+			return 5;
+		});
+		assert((v == Vec<int>{1, 2, 3, 4, 5}));
+		v.resize_and_overwrite(2, [](int* p, size_t){ p[1] = 20; return 2u; });
+		assert((v == Vec<int>{1, 20}));
+
+		// if op throws, we are left with the elements we had
+		bool threw = false;
+		try{
+			v.resize_and_overwrite(100, [](int*, size_t) -> size_t{
+				throw std::runtime_error("decoder failed");
+			});
+		} catch(const std::runtime_error&){
+			threw = true;
+		}
+		assert(threw && (v == Vec<int>{1, 20}) && v.capacity() >= 100);
+
+		// any integer will do for the count, even a bool or a char
+		v.resize_and_overwrite(4, [](int* p, size_t){ p[2] = 3; return char{3}; });
+		assert((v == Vec<int>{1, 20, 3}));
+		v.resize_and_overwrite(3, [](int*, size_t){ return true; });
+		assert((v == Vec<int>{1}));
+
+		// only for types that can live in uninitialized memory
+		static_assert(overwritable<Vec<std::byte>> && !overwritable<Vec<std::string>>);
+	}
+
+	// 34) PoolVec: buffers are recycled by size class, by a pool per thread
+	{
+		BufferPool::set_limits(BufferPoolLimits{});
+		BufferPool::reset_stats();
+
+		// the same request, over and over: one trip to the heap, then the pool serves it
+		const int* first_buffer = nullptr;
+		for(int request = 0; request < 1000; ++request){
+			PoolVec<int> v(100, request);
+			if(request == 0){
+				first_buffer = v.data();
+			}
+			assert(v.data() == first_buffer && v[99] == request);
+		}
+		BufferPoolStats stats = BufferPool::stats();
+		assert(stats.misses == 1 && stats.hits == 999 && stats.recycled == 1000);
+		assert(stats.hit_rate() > 0.99 && BufferPool::cached_buffers() == 1);
+
+		// buffers are rounded up to a power of two, so similar sizes share a class
+		{
+			const PoolVec<int> bigger(120, 0); // 480 bytes, in the 512 byte class with 400
+			assert(bigger.data() == first_buffer && BufferPool::stats().hits == 1000);
+		}
+
+		// the caps decide what is kept when it comes back
+		BufferPool::set_limits({.buffers_per_class = 2, .max_buffer_bytes = 4096});
+		assert(BufferPool::cached_buffers() == 0 && BufferPool::limits().buffers_per_class == 2);
+		BufferPool::reset_stats();
+		{
+			const PoolVec<int> a(100), b(100), c(100);
+			const PoolVec<int> large(10000); // 40000 bytes, over max_buffer_bytes
+		}
+		stats = BufferPool::stats();
+		assert(stats.misses == 4 && stats.recycled == 2 && stats.released == 2);
+		assert(BufferPool::cached_buffers() == 2);
+
+		// growing by push_back goes through the pool too
+		BufferPool::reset_stats();
+		{
+			PoolVec<int> grown;
+			for(int i = 0; i < 1000; ++i){
+				grown.push_back(i);
+			}
+			assert(grown.size() == 1000 && grown[999] == 999);
+		}
+		assert(BufferPool::stats().hits >= 1 && BufferPool::stats().recycled > 0);
+		BufferPool::trim();
+		assert(BufferPool::cached_buffers() == 0);
+
+		// every thread has its own pool, and any pool can take back any buffer
+		PoolVec<int> from_main(100, 7);
+		size_t thread_hits = 1;
+		std::jthread([&]{
+			thread_hits = BufferPool::stats().hits;
+			PoolVec<int> moved = std::move(from_main);
+			assert(moved[99] == 7);
+		}).join();
+		assert(thread_hits == 0 && from_main.empty());
+		BufferPool::set_limits(BufferPoolLimits{});
+	}
+
 	return 0;
 }